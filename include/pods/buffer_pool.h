@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <cassert>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "details/settings.h"
+
+#include "buffers.h"
+#include "types.h"
+
+namespace pods
+{
+    // thread safe cache of resizable buffers, a released buffer keeps
+    // the capacity it has grown to, so the next user does not reallocate it,
+    // the memory resource (if any) has to be thread safe too
+    class BufferPool final
+    {
+    public:
+        explicit BufferPool(
+            size_t maxBuffers = std::numeric_limits<size_t>::max(),
+            size_t initialSize = details::PrefferedBufferSize,
+            size_t maxSize = std::numeric_limits<Size>::max(),
+            std::pmr::memory_resource* resource = nullptr) noexcept
+            : maxBuffers_(maxBuffers)
+            , initialSize_(initialSize)
+            , maxSize_(maxSize)
+            , resource_(resource)
+        {
+            assert(initialSize <= maxSize);
+        }
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        BufferPool(BufferPool&&) = delete;
+        BufferPool& operator=(BufferPool&&) = delete;
+
+        // returns an empty buffer
+        ResizableOutputBuffer acquire()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!free_.empty())
+                {
+                    auto buffer = std::move(free_.back());
+                    free_.pop_back();
+                    return buffer;
+                }
+            }
+
+            return ResizableOutputBuffer(initialSize_, maxSize_, resource_);
+        }
+
+        // the buffer is destroyed if the pool already holds maxBuffers
+        void release(ResizableOutputBuffer&& buffer)
+        {
+            buffer.clear();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.size() < maxBuffers_)
+            {
+                free_.push_back(std::move(buffer));
+            }
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return free_.size();
+        }
+
+    private:
+        const size_t maxBuffers_;
+        const size_t initialSize_;
+        const size_t maxSize_;
+        std::pmr::memory_resource* const resource_;
+
+        mutable std::mutex mutex_;
+        std::vector<ResizableOutputBuffer> free_;
+    };
+}
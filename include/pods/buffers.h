@@ -5,8 +5,11 @@
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
+#include <utility>
 
+#include "details/memory.h"
 #include "details/settings.h"
 #include "details/utils.h"
 
@@ -19,8 +22,11 @@ namespace pods
     {
         friend class InputStream;
     public:
-        explicit InputBuffer(size_t size)
-            : allocated_(static_cast<char*>(malloc(size)))
+        // memory is taken from the resource if it is given, otherwise from malloc
+        explicit InputBuffer(size_t size, std::pmr::memory_resource* resource = nullptr)
+            : resource_(resource)
+            , allocated_(details::allocate(resource, size))
+            , allocatedSize_(size)
             , maxSize_(size)
             , data_(allocated_)
             , pos_(0)
@@ -34,27 +40,49 @@ namespace pods
         }
 
         InputBuffer(const char* data, size_t size) noexcept
-            : allocated_(nullptr)
+            : resource_(nullptr)
+            , allocated_(nullptr)
+            , allocatedSize_(0)
             , maxSize_(size)
             , data_(data)
             , pos_(0)
         {
-            assert(size > 0);
+            assert(data != nullptr || size == 0);
         }
 
         ~InputBuffer()
         {
-            if (allocated_ != nullptr)
-            {
-                free(allocated_);
-            }
+            details::deallocate(resource_, allocated_, allocatedSize_);
         }
 
         InputBuffer(const InputBuffer&) = delete;
         InputBuffer& operator=(const InputBuffer&) = delete;
 
-        InputBuffer(InputBuffer&&) = delete;
-        InputBuffer& operator=(InputBuffer&&) = delete;
+        InputBuffer(InputBuffer&& other) noexcept
+            : resource_(other.resource_)
+            , allocated_(std::exchange(other.allocated_, nullptr))
+            , allocatedSize_(std::exchange(other.allocatedSize_, 0))
+            , maxSize_(std::exchange(other.maxSize_, 0))
+            , data_(std::exchange(other.data_, nullptr))
+            , pos_(std::exchange(other.pos_, 0))
+        {
+        }
+
+        InputBuffer& operator=(InputBuffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                details::deallocate(resource_, allocated_, allocatedSize_);
+
+                resource_ = other.resource_;
+                allocated_ = std::exchange(other.allocated_, nullptr);
+                allocatedSize_ = std::exchange(other.allocatedSize_, 0);
+                maxSize_ = std::exchange(other.maxSize_, 0);
+                data_ = std::exchange(other.data_, nullptr);
+                pos_ = std::exchange(other.pos_, 0);
+            }
+            return *this;
+        }
 
         Error get(bool& value) noexcept
         {
@@ -114,15 +142,44 @@ namespace pods
             return get(reinterpret_cast<char*>(data), totalSize);
         }
 
+        // points data to the next size bytes of the buffer without copying them,
+        // the pointer is valid while the underlying memory is alive
+        Error view(const char*& data, size_t size) noexcept
+        {
+            if (pos_ + size <= maxSize_)
+            {
+                data = data_ + pos_;
+                pos_ += size;
+                return Error::NoError;
+            }
+
+            return Error::UnexpectedEnd;
+        }
+
+        size_t available() const noexcept
+        {
+            return maxSize_ - pos_;
+        }
+
     private:
         void gotoEnd() noexcept
         {
             pos_ = maxSize_;
         }
 
+        // moves the unread bytes to the beginning of the owned memory
+        size_t compact() noexcept
+        {
+            assert(allocated_ != nullptr);
+            const auto rest = available();
+            memmove(allocated_, data_ + pos_, rest);
+            maxSize_ = rest;
+            pos_ = 0;
+            return rest;
+        }
+
         void reset(size_t newSize) noexcept
         {
-            assert(newSize <= maxSize_);
             maxSize_ = newSize;
             pos_ = 0;
         }
@@ -132,28 +189,50 @@ namespace pods
             return allocated_;
         }
 
-        size_t maxSize() const noexcept
+
+    private:
+        std::pmr::memory_resource* resource_;
+
+        char* allocated_;
+        size_t allocatedSize_;
+        size_t maxSize_;
+        const char* data_;
+        size_t pos_;
+    };
+
+    // wraps writable memory of the caller, the in-situ deserializers decode
+    // the strings in place, so the content is modified while it is loaded
+    class InsituInputBuffer final
+        : public InputBuffer
+    {
+    public:
+        InsituInputBuffer(char* data, size_t size) noexcept
+            : InputBuffer(data, size)
+            , data_(data)
         {
-            return maxSize_;
         }
 
-        size_t available() const noexcept
+        using InputBuffer::view;
+
+        Error view(char*& data, size_t size) noexcept
         {
-            return maxSize_ - pos_;
+            const char* begin = nullptr;
+            PODS_SAFE_CALL(InputBuffer::view(begin, size));
+            data = data_ + (begin - data_);
+            return Error::NoError;
         }
 
     private:
-        char* allocated_;
-        size_t maxSize_;
-        const char* data_;
-        size_t pos_;
+        char* data_;
     };
 
     class OutputBuffer final
     {
     public:
-        explicit OutputBuffer(size_t size)
-            : data_(static_cast<char*>(malloc(size)))
+        // memory is taken from the resource if it is given, otherwise from malloc
+        explicit OutputBuffer(size_t size, std::pmr::memory_resource* resource = nullptr)
+            : resource_(resource)
+            , data_(details::allocate(resource, size))
             , begin_(data_)
             , current_(data_)
             , end_(data_ + size)
@@ -165,7 +244,8 @@ namespace pods
         }
 
         OutputBuffer(char* data, size_t size) noexcept
-            : data_(nullptr)
+            : resource_(nullptr)
+            , data_(nullptr)
             , begin_(data)
             , current_(data)
             , end_(data + size)
@@ -176,15 +256,39 @@ namespace pods
         {
             if (data_ != nullptr)
             {
-                free(data_);
+                details::deallocate(resource_, data_, static_cast<size_t>(end_ - begin_));
             }
         }
 
         OutputBuffer(const OutputBuffer&) = delete;
         OutputBuffer& operator=(const OutputBuffer&) = delete;
 
-        OutputBuffer(OutputBuffer&&) = delete;
-        OutputBuffer& operator=(OutputBuffer&&) = delete;
+        OutputBuffer(OutputBuffer&& other) noexcept
+            : resource_(other.resource_)
+            , data_(std::exchange(other.data_, nullptr))
+            , begin_(std::exchange(other.begin_, nullptr))
+            , current_(std::exchange(other.current_, nullptr))
+            , end_(std::exchange(other.end_, nullptr))
+        {
+        }
+
+        OutputBuffer& operator=(OutputBuffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (data_ != nullptr)
+                {
+                    details::deallocate(resource_, data_, static_cast<size_t>(end_ - begin_));
+                }
+
+                resource_ = other.resource_;
+                data_ = std::exchange(other.data_, nullptr);
+                begin_ = std::exchange(other.begin_, nullptr);
+                current_ = std::exchange(other.current_, nullptr);
+                end_ = std::exchange(other.end_, nullptr);
+            }
+            return *this;
+        }
 
         Error put(bool value)
         {
@@ -231,6 +335,38 @@ namespace pods
             return put(reinterpret_cast<const char*>(data), totalSize);
         }
 
+        // guarantees that the next size bytes can be written by putUnchecked
+        Error reserve(size_t size) noexcept
+        {
+            return size <= available()
+                ? Error::NoError
+                : Error::NotEnoughMemory;
+        }
+
+        template <class T>
+        void putUnchecked(T value) noexcept
+        {
+            assert(sizeof(T) <= available());
+            memcpy(current_, &value, sizeof(T));
+            current_ += sizeof(T);
+        }
+
+        // points to the free memory of the buffer, at least size bytes, the bytes written
+        // there are appended by commit(), the memory is valid until the buffer grows
+        Error reserve(size_t size, char*& begin, char*& end) noexcept
+        {
+            PODS_SAFE_CALL(reserve(size));
+            begin = current_;
+            end = end_;
+            return Error::NoError;
+        }
+
+        void commit(char* end) noexcept
+        {
+            assert(current_ <= end && end <= end_);
+            current_ = end;
+        }
+
         const char* data() const noexcept
         {
             return begin_;
@@ -258,11 +394,13 @@ namespace pods
         }
 
     private:
-        char* const data_;
+        std::pmr::memory_resource* resource_;
+
+        char* data_;
 
-        char* const begin_;
+        char* begin_;
         char* current_;
-        char* const end_;
+        char* end_;
     };
 
     class ResizableOutputBuffer final
@@ -270,25 +408,49 @@ namespace pods
     public:
         explicit ResizableOutputBuffer(
             size_t initialSize = details::PrefferedBufferSize,
-            size_t maxSize = std::numeric_limits<uint32_t>::max()) noexcept
-            : maxSize_(maxSize)
-            , data_(static_cast<char*>(malloc(initialSize)))
+            size_t maxSize = std::numeric_limits<Size>::max(),
+            std::pmr::memory_resource* resource = nullptr) noexcept
+            : resource_(resource)
+            , maxSize_(maxSize)
+            , data_(details::allocate(resource, initialSize))
             , current_(data_)
-            , available_(initialSize)
+            , available_(data_ == nullptr ? 0 : initialSize)
         {
             assert(initialSize <= maxSize);
         }
 
         ~ResizableOutputBuffer()
         {
-            free(data_);
+            details::deallocate(resource_, data_, capacity());
         }
 
         ResizableOutputBuffer(const ResizableOutputBuffer&) = delete;
         ResizableOutputBuffer& operator=(const ResizableOutputBuffer&) = delete;
 
-        ResizableOutputBuffer(ResizableOutputBuffer&&) = delete;
-        ResizableOutputBuffer& operator=(ResizableOutputBuffer&&) = delete;
+        // the moved from buffer stays usable, it allocates memory on the next write
+        ResizableOutputBuffer(ResizableOutputBuffer&& other) noexcept
+            : resource_(other.resource_)
+            , maxSize_(other.maxSize_)
+            , data_(std::exchange(other.data_, nullptr))
+            , current_(std::exchange(other.current_, nullptr))
+            , available_(std::exchange(other.available_, 0))
+        {
+        }
+
+        ResizableOutputBuffer& operator=(ResizableOutputBuffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                details::deallocate(resource_, data_, capacity());
+
+                resource_ = other.resource_;
+                maxSize_ = other.maxSize_;
+                data_ = std::exchange(other.data_, nullptr);
+                current_ = std::exchange(other.current_, nullptr);
+                available_ = std::exchange(other.available_, 0);
+            }
+            return *this;
+        }
 
         Error put(bool value)
         {
@@ -318,7 +480,7 @@ namespace pods
         {
             assert(size <= std::numeric_limits<Size>::max()); // is checked in the serializer
 
-            auto to = getPtr(static_cast<Size>(size));
+            auto to = getPtr(size);
             if (to != nullptr)
             {
                 memcpy(to, data, size);
@@ -336,6 +498,40 @@ namespace pods
             return put(reinterpret_cast<const char*>(data), totalSize);
         }
 
+        // guarantees that the next size bytes can be written by putUnchecked
+        Error reserve(size_t size) noexcept
+        {
+            return size <= available_ || grow(size)
+                ? Error::NoError
+                : Error::NotEnoughMemory;
+        }
+
+        template <class T>
+        void putUnchecked(T value) noexcept
+        {
+            assert(sizeof(T) <= available_);
+            memcpy(current_, &value, sizeof(T));
+            current_ += sizeof(T);
+            available_ -= sizeof(T);
+        }
+
+        // points to the free memory of the buffer, at least size bytes, the bytes written
+        // there are appended by commit(), the memory is valid until the buffer grows
+        Error reserve(size_t size, char*& begin, char*& end) noexcept
+        {
+            PODS_SAFE_CALL(reserve(size));
+            begin = current_;
+            end = current_ + available_;
+            return Error::NoError;
+        }
+
+        void commit(char* end) noexcept
+        {
+            assert(current_ <= end && static_cast<size_t>(end - current_) <= available_);
+            available_ -= static_cast<size_t>(end - current_);
+            current_ = end;
+        }
+
         const char* data() const noexcept
         {
             return data_;
@@ -363,34 +559,223 @@ namespace pods
         }
 
     private:
-        char* getPtr(Size size) noexcept
+        char* getPtr(size_t size) noexcept
         {
-            if (size <= available_)
+            if (size > available_ && !grow(size))
             {
-                available_ -= size;
-                auto ptr = current_;
-                current_ += size;
-                return ptr;
+                return nullptr;
             }
 
+            available_ -= size;
+            auto ptr = current_;
+            current_ += size;
+            return ptr;
+        }
+
+        bool grow(size_t size) noexcept
+        {
             const auto used = this->size();
-            if (used + size <= maxSize_)
+            if (used + size > maxSize_)
             {
-                const auto newSize = std::min<size_t>(maxSize_, (used + size) * 2);
-                auto newPtr = realloc(data_, newSize);
-                if (newPtr == nullptr)
+                return false;
+            }
+
+            const auto newSize = std::min<size_t>(maxSize_, (used + size) * 2);
+            auto newPtr = details::reallocate(resource_, data_, capacity(), used, newSize);
+            if (newPtr == nullptr)
+            {
+                return false;
+            }
+
+            data_ = newPtr;
+            current_ = data_ + used;
+            available_ = newSize - used;
+            return true;
+        }
+
+    private:
+        std::pmr::memory_resource* resource_;
+
+        size_t maxSize_;
+
+        char* data_;
+        char* current_;
+        size_t available_;
+    };
+
+    // keeps the first N bytes inside the object itself (for example on the stack)
+    // and moves to the heap only when the data outgrows them
+    template <size_t N>
+    class StackOutputBuffer final
+    {
+        static_assert(N > 0, "Inline capacity must be positive");
+
+    public:
+        explicit StackOutputBuffer(size_t maxSize = std::numeric_limits<Size>::max()) noexcept
+            : maxSize_(maxSize)
+            , data_(inline_)
+            , current_(inline_)
+            , end_(inline_ + std::min(N, maxSize))
+        {
+        }
+
+        ~StackOutputBuffer()
+        {
+            if (data_ != inline_)
+            {
+                free(data_);
+            }
+        }
+
+        StackOutputBuffer(const StackOutputBuffer&) = delete;
+        StackOutputBuffer& operator=(const StackOutputBuffer&) = delete;
+
+        StackOutputBuffer(StackOutputBuffer&&) = delete;
+        StackOutputBuffer& operator=(StackOutputBuffer&&) = delete;
+
+        Error put(bool value)
+        {
+            return put(value ? True : False);
+        }
+
+        template <class T, typename std::enable_if<sizeof(T) == 1, int>::type = 0>
+        Error put(T value)
+        {
+            if (current_ == end_ && !grow(sizeof(T)))
+            {
+                return Error::NotEnoughMemory;
+            }
+
+            *current_++ = static_cast<char>(value);
+            return Error::NoError;
+        }
+
+        template <class T, typename std::enable_if<sizeof(T) != 1, int>::type = 0>
+        Error put(T value)
+        {
+            return put(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        Error put(const char* data, size_t size)
+        {
+            if (size > available() && !grow(size))
+            {
+                return Error::NotEnoughMemory;
+            }
+
+            memcpy(current_, data, size);
+            current_ += size;
+            return Error::NoError;
+        }
+
+        template <class T>
+        Error put(const T* data, size_t size)
+        {
+            const auto totalSize = size * sizeof(T);
+            return put(reinterpret_cast<const char*>(data), totalSize);
+        }
+
+        // guarantees that the next size bytes can be written by putUnchecked
+        Error reserve(size_t size) noexcept
+        {
+            return size <= available() || grow(size)
+                ? Error::NoError
+                : Error::NotEnoughMemory;
+        }
+
+        template <class T>
+        void putUnchecked(T value) noexcept
+        {
+            assert(sizeof(T) <= available());
+            memcpy(current_, &value, sizeof(T));
+            current_ += sizeof(T);
+        }
+
+        // points to the free memory of the buffer, at least size bytes, the bytes written
+        // there are appended by commit(), the memory is valid until the buffer grows
+        Error reserve(size_t size, char*& begin, char*& end) noexcept
+        {
+            PODS_SAFE_CALL(reserve(size));
+            begin = current_;
+            end = end_;
+            return Error::NoError;
+        }
+
+        void commit(char* end) noexcept
+        {
+            assert(current_ <= end && end <= end_);
+            current_ = end;
+        }
+
+        const char* data() const noexcept
+        {
+            return data_;
+        }
+
+        size_t size() const noexcept
+        {
+            return static_cast<size_t>(current_ - data_);
+        }
+
+        size_t capacity() const noexcept
+        {
+            return static_cast<size_t>(end_ - data_);
+        }
+
+        bool isInline() const noexcept
+        {
+            return data_ == inline_;
+        }
+
+        // keeps the heap memory if it was allocated
+        void clear() noexcept
+        {
+            current_ = data_;
+        }
+
+        void flush() noexcept
+        {
+        }
+
+    private:
+        size_t available() const noexcept
+        {
+            return static_cast<size_t>(end_ - current_);
+        }
+
+        bool grow(size_t size) noexcept
+        {
+            const auto used = this->size();
+            if (size > maxSize_ - used)
+            {
+                return false;
+            }
+
+            const auto newSize = std::min<size_t>(maxSize_, (used + size) * 2);
+
+            char* newPtr = nullptr;
+            if (data_ == inline_)
+            {
+                newPtr = static_cast<char*>(malloc(newSize));
+                if (newPtr != nullptr)
                 {
-                    return nullptr;
+                    memcpy(newPtr, inline_, used);
                 }
+            }
+            else
+            {
+                newPtr = static_cast<char*>(realloc(data_, newSize));
+            }
 
-                data_ = static_cast<char*>(newPtr);
-                available_ = newSize - used - size;
-                auto ptr = data_ + used;
-                current_ = ptr + size;
-                return ptr;
+            if (newPtr == nullptr)
+            {
+                return false;
             }
 
-            return nullptr;
+            data_ = newPtr;
+            current_ = data_ + used;
+            end_ = data_ + newSize;
+            return true;
         }
 
     private:
@@ -398,6 +783,8 @@ namespace pods
 
         char* data_;
         char* current_;
-        size_t available_;
+        char* end_;
+
+        char inline_[N];
     };
 }
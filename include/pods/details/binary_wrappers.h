@@ -70,10 +70,33 @@ namespace pods
                 return storage_.size() * sizeof(T);
             }
 
+            const std::vector<T>& storage() const noexcept
+            {
+                return storage_;
+            }
+
         private:
             std::vector<T>& storage_;
         };
 
+        // the address of the member that the field refers to
+        template <class T>
+        const void* getAddress(const T& value) noexcept
+        {
+            return &value;
+        }
+
+        inline const void* getAddress(const BinaryArray& value) noexcept
+        {
+            return value.data();
+        }
+
+        template <class T>
+        const void* getAddress(const BinaryVector<T>& value) noexcept
+        {
+            return &value.storage();
+        }
+
         template <class T, size_t ArraySize>
         BinaryArray makeBinary(T (&value)[ArraySize])
         {
@@ -1,9 +1,14 @@
 ﻿#pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
+#include <span>
 #include <string>
+#include <string_view>
 
 #include <array>
 #include <vector>
@@ -20,6 +25,7 @@
 #include <queue>
 
 #include "binary_wrappers.h"
+#include "field_table.h"
 #include "utils.h"
 
 #include "../errors.h"
@@ -47,6 +53,40 @@ namespace pods
                 return deserialize(data);
             }
 
+            // loads the given members of data and skips the other fields without
+            // decoding them, the members that are structs are loaded entirely
+            template <class T, class... MembersT>
+            Error loadOnly(T& data, MembersT T::*... members)
+            {
+                static_assert(sizeof...(MembersT) > 0, "Select at least one member");
+
+                const void* const selected[] = { &(data.*members)... };
+
+                selected_ = selected;
+                mode_ = Mode::Project;
+
+                const auto error = deserialize(data);
+
+                selected_ = {};
+                mode_ = Mode::Load;
+
+                return error;
+            }
+
+            // a value that is not a field of a struct
+            template <class T>
+            Error loadValue(T& value)
+            {
+                return processValue(value);
+            }
+
+            // skips a value of the type of schema, the schema is not modified
+            template <class T>
+            Error skip(T& schema)
+            {
+                return skipValue(schema);
+            }
+
             Error operator()() noexcept
             {
                 return Error::NoError;
@@ -55,7 +95,7 @@ namespace pods
             template <class... ArgsT>
             Error operator()(ArgsT&&... args)
             {
-                return processField(args...);
+                return processFields<void>(args...);
             }
 
         private:
@@ -66,17 +106,157 @@ namespace pods
                     "You must define the serialize() method for each serializable struct");
 
                 PODS_SAFE_CALL(format_.startDeserialization());
-                PODS_SAFE_CALL(value.serialize(*this));
+                FieldsOf<T> fields { *this };
+                PODS_SAFE_CALL(value.serialize(fields));
                 return format_.endDeserialization();
             }
 
+            // passes the type of the struct to processFields
+            template <class Struct>
+            struct FieldsOf final
+            {
+                Error operator()() noexcept
+                {
+                    return Error::NoError;
+                }
+
+                template <class... ArgsT>
+                Error operator()(ArgsT&&... args)
+                {
+                    return deserializer_.template processFields<Struct>(args...);
+                }
+
+                Deserializer& deserializer_;
+            };
+
+            template <class Struct, class... ArgsT>
+            Error processFields(ArgsT&... args)
+            {
+                if constexpr (IsKeyedFormat<Format>::value)
+                {
+                    auto fields = std::tie(args...);
+                    return processKeyedFields<Struct>(fields, std::make_index_sequence<sizeof...(ArgsT) / 2>());
+                }
+                else
+                {
+                    return processField(args...);
+                }
+            }
+
+            // the fields come in any order, the perfect hash table of the struct finds
+            // the index of the field by its key and the jump table calls the loader
+            template <class Struct, class Fields, size_t... I>
+            Error processKeyedFields(Fields& fields, std::index_sequence<I...>)
+            {
+                constexpr size_t FieldCount = sizeof...(I);
+
+                using Loader = Error (*)(Deserializer&, Fields&);
+                static constexpr Loader loaders[] = { &Deserializer::loadKeyedField<Fields, I>... };
+
+                using FieldId = decltype(Format::fieldId(""));
+                using FieldIds = std::array<FieldId, FieldCount>;
+
+                const char* const names[] = { std::get<I * 2>(fields)... };
+
+                const FieldIds* ids = nullptr;
+                const FieldTable<FieldCount>* table = nullptr;
+
+                FieldIds callIds {};
+                if constexpr (!std::is_void<Struct>::value)
+                {
+                    // the names of a struct are the same string literals on every call,
+                    // so its ids and the table are computed once
+                    static const auto structKeys = [&]()
+                    {
+                        const FieldIds structIds = { Format::fieldId(names[I])... };
+                        const uint32_t hashes[] = { Format::fieldHash(structIds[I])... };
+                        return FieldKeys<FieldId, FieldCount> { structIds, hasCollisions(structIds), FieldTable<FieldCount>(hashes) };
+                    }();
+
+                    if (structKeys.collides)
+                    {
+                        // rename one of the fields
+                        return Error::FieldIdCollision;
+                    }
+
+                    ids = &structKeys.ids;
+                    table = &structKeys.table;
+                }
+                else
+                {
+                    // serialize() is called with the deserializer itself, there is
+                    // no struct to keep the ids for, so they are checked every time
+                    callIds = { Format::fieldId(names[I])... };
+                    if (hasCollisions(callIds))
+                    {
+                        return Error::FieldIdCollision;
+                    }
+
+                    ids = &callIds;
+                }
+
+                bool loaded[FieldCount] = {};
+
+                // the fields are usually in the order of the struct
+                size_t next = 0;
+                while (true)
+                {
+                    FieldId id {};
+                    const auto error = format_.loadFieldId(id);
+                    if (error == Error::EndOfObject)
+                    {
+                        break;
+                    }
+                    PODS_SAFE_CALL(error);
+
+                    auto index = next < FieldCount && (*ids)[next] == id
+                        ? next
+                        : find(table, *ids, id);
+
+                    if (index == FieldCount || !((*ids)[index] == id))
+                    {
+                        PODS_SAFE_CALL(format_.skipValue());
+                        continue;
+                    }
+
+                    PODS_SAFE_CALL(loaders[index](*this, fields));
+                    loaded[index] = true;
+                    next = index + 1;
+                }
+
+                for (size_t i = 0; i < FieldCount; ++i)
+                {
+                    if (!loaded[i] && !isOptional(names[i]))
+                    {
+                        return Error::MandatoryFieldMissed;
+                    }
+                }
+
+                return Error::NoError;
+            }
+
+            // without the table the fields are looked up one by one
+            template <size_t FieldCount, class FieldId>
+            static size_t find(const FieldTable<FieldCount>* table, const std::array<FieldId, FieldCount>& ids, const FieldId& id)
+            {
+                return table != nullptr
+                    ? table->find(Format::fieldHash(id))
+                    : static_cast<size_t>(std::find(ids.begin(), ids.end(), id) - ids.begin());
+            }
+
+            template <class Fields, size_t I>
+            static Error loadKeyedField(Deserializer& deserializer, Fields& fields)
+            {
+                return deserializer.loadMember(std::get<I * 2 + 1>(fields));
+            }
+
             template <class T>
             Error processField(const char* name, T& value)
             {
                 const auto result = format_.checkName(name);
                 if (result == Error::NoError)
                 {
-                    return processValue(value);
+                    return loadMember(value);
                 }
 
                 return result == Error::OptionalFieldMissed
@@ -90,7 +270,7 @@ namespace pods
                 const auto result = format_.checkName(name);
                 if (result == Error::NoError)
                 {
-                    const auto error = processValue(value);
+                    const auto error = loadMember(value);
                     return error == Error::NoError
                         ? processField(args...)
                         : error;
@@ -101,6 +281,137 @@ namespace pods
                     : result;
             }
 
+            template <class T>
+            Error loadMember(T& value)
+            {
+                return mode_ == Mode::Load
+                    ? processValue(value)
+                    : projectMember(value);
+            }
+
+            // the selected members of the top level struct are loaded, the other fields are skipped
+            template <class T>
+            Error projectMember(T& value)
+            {
+                if (mode_ == Mode::Project
+                    && std::find(selected_.begin(), selected_.end(), getAddress(value)) != selected_.end())
+                {
+                    mode_ = Mode::Load;
+                    const auto error = processValue(value);
+                    mode_ = Mode::Project;
+                    return error;
+                }
+
+                return skipValue(value);
+            }
+
+            // the value is only a schema, it is not modified
+            template <class T>
+            Error skipValue(T& value)
+            {
+                if constexpr (Format::SelfDescribingObjects)
+                {
+                    return format_.skipValue();
+                }
+                else if constexpr (IsPodsSerializable<T, decltype(this)>::value)
+                {
+                    // the fields of a struct are not framed, so the struct walks over them
+                    const auto mode = std::exchange(mode_, Mode::Skip);
+                    PODS_SAFE_CALL(format_.startDeserialization());
+                    PODS_SAFE_CALL(value.serialize(*this));
+                    mode_ = mode;
+                    return format_.endDeserialization();
+                }
+                else
+                {
+                    return format_.skipValue();
+                }
+            }
+
+            template <class T, size_t ArraySize>
+            Error skipValue(T(&)[ArraySize])
+            {
+                return skipItems<T>();
+            }
+
+            template <class T, size_t ArraySize>
+            Error skipValue(std::array<T, ArraySize>&)
+            {
+                return skipItems<T>();
+            }
+
+            template <class T>
+            Error skipValue(std::vector<T>&)
+            {
+                return skipItems<T>();
+            }
+
+            template <class T>
+            Error skipValue(std::deque<T>&)
+            {
+                return skipItems<T>();
+            }
+
+            template <class T>
+            Error skipValue(std::forward_list<T>&)
+            {
+                return skipItems<T>();
+            }
+
+            template <class T>
+            Error skipValue(std::list<T>&)
+            {
+                return skipItems<T>();
+            }
+
+            template <class Key, class Val>
+            Error skipValue(std::map<Key, Val>&)
+            {
+                if constexpr (Format::SelfDescribingObjects)
+                {
+                    return format_.skipValue();
+                }
+                else
+                {
+                    Size size = 0;
+                    PODS_SAFE_CALL(format_.startMap(size));
+
+                    Key key {};
+                    Val val {};
+                    for (Size i = 0; i < size; ++i)
+                    {
+                        PODS_SAFE_CALL(skipValue(key));
+                        PODS_SAFE_CALL(skipValue(val));
+                    }
+
+                    return format_.endMap();
+                }
+            }
+
+            // only the items that are structs need the walk,
+            // one default constructed item is the schema for all of them
+            template <class T>
+            Error skipItems()
+            {
+                if constexpr (Format::SelfDescribingObjects || !std::is_class<T>::value)
+                {
+                    return format_.skipValue();
+                }
+                else
+                {
+                    Size size = 0;
+                    PODS_SAFE_CALL(format_.startArray(size));
+
+                    T item {};
+                    for (Size i = 0; i < size; ++i)
+                    {
+                        PODS_SAFE_CALL(skipValue(item));
+                    }
+
+                    return format_.endArray();
+                }
+            }
+
             template <class T, typename std::enable_if<std::is_class<T>::value, int>::type = 0>
             Error processValue(T& value)
             {
@@ -127,6 +438,33 @@ namespace pods
                 return format_.load(value);
             }
 
+            Error processValue(std::string_view& value)
+            {
+                return format_.load(value);
+            }
+
+            template <class T>
+            Error processValue(std::span<const T>& value)
+            {
+                static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+                std::span<const char> bytes;
+                PODS_SAFE_CALL(format_.loadBlob(bytes));
+
+                if (bytes.size() % sizeof(T) != 0)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(T) != 0)
+                {
+                    return Error::UnalignedData;
+                }
+
+                value = std::span<const T>(reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T));
+                return Error::NoError;
+            }
+
             Error processValue(BinaryArray& value)
             {
                 return format_.loadBlob(value.data(), value.size());
@@ -167,6 +505,12 @@ namespace pods
                         return Error::CorruptedArchive;
                     }
 
+                    if constexpr (HasArrayLoad<Format, T>::value)
+                    {
+                        PODS_SAFE_CALL(format_.loadArrayItems(begin, size));
+                        return format_.endArray();
+                    }
+
                     for (Size i = 0; i < size; ++i)
                     {
                         PODS_SAFE_CALL(processValue(*begin++));
@@ -204,7 +548,20 @@ namespace pods
             template <class T>
             Error processValue(std::vector<T>& value)
             {
-                return loadSequense(value);
+                if constexpr (Format::Traits::SupportsSeqSizes && HasArrayLoad<Format, T>::value)
+                {
+                    Size size = 0;
+                    PODS_SAFE_CALL(format_.startArray(size));
+
+                    value.resize(size);
+
+                    PODS_SAFE_CALL(format_.loadArrayItems(value.data(), size));
+                    return format_.endArray();
+                }
+                else
+                {
+                    return loadSequense(value);
+                }
             }
 
             template <class T>
@@ -449,7 +806,17 @@ namespace pods
             }
 
         private:
+            enum class Mode
+            {
+                Load,
+                Project,
+                Skip
+            };
+
             Format format_;
+
+            Mode mode_ = Mode::Load;
+            std::span<const void* const> selected_;
         };
     }
 }
@@ -0,0 +1,125 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pods
+{
+    namespace details
+    {
+        // FNV-1a
+        constexpr uint32_t hashName(std::string_view name) noexcept
+        {
+            uint32_t hash = 2166136261u;
+            for (const auto c : name)
+            {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+            }
+            return hash;
+        }
+
+        // a perfect hash table from the hashes of the fields of a struct to their indices,
+        // a lookup is one multiplication and one load, the caller compares the key
+        // of the found field, because an unknown key lands on some slot too
+        template <size_t FieldCount>
+        class FieldTable final
+        {
+            static constexpr size_t SlotCount = std::bit_ceil(FieldCount * 4);
+            static constexpr int Shift = 32 - std::countr_zero(SlotCount);
+
+            static constexpr uint16_t Empty = UINT16_MAX;
+
+            static_assert(FieldCount < Empty, "Too many fields");
+
+        public:
+            constexpr explicit FieldTable(const uint32_t (&hashes)[FieldCount]) noexcept
+            {
+                std::copy(hashes, hashes + FieldCount, hashes_);
+
+                for (const auto hash : hashes_)
+                {
+                    if (std::count(hashes_, hashes_ + FieldCount, hash) > 1)
+                    {
+                        // the fields are looked up one by one
+                        return;
+                    }
+                }
+
+                // the chance that a seed fits is above 1/20 for 40 fields
+                for (uint32_t seed = 1; !tryFill(seed); ++seed)
+                {
+                }
+            }
+
+            // returns the index of the only field that may have the hash or FieldCount
+            constexpr size_t find(uint32_t hash) const noexcept
+            {
+                if (seed_ == 0)
+                {
+                    return static_cast<size_t>(std::find(hashes_, hashes_ + FieldCount, hash) - hashes_);
+                }
+
+                const auto index = slots_[slot(hash, seed_)];
+                return index == Empty
+                    ? FieldCount
+                    : index;
+            }
+
+        private:
+            static constexpr size_t slot(uint32_t hash, uint32_t seed) noexcept
+            {
+                return static_cast<uint32_t>((hash ^ seed) * 2654435761u) >> Shift;
+            }
+
+            constexpr bool tryFill(uint32_t seed) noexcept
+            {
+                std::fill(slots_, slots_ + SlotCount, Empty);
+
+                for (size_t i = 0; i < FieldCount; ++i)
+                {
+                    auto& index = slots_[slot(hashes_[i], seed)];
+                    if (index != Empty)
+                    {
+                        return false;
+                    }
+                    index = static_cast<uint16_t>(i);
+                }
+
+                seed_ = seed;
+                return true;
+            }
+
+        private:
+            uint32_t hashes_[FieldCount] = {};
+            uint32_t seed_ = 0;
+            uint16_t slots_[SlotCount] = {};
+        };
+
+        // two fields with the same id cannot be told apart in an archive
+        template <class FieldId, size_t FieldCount>
+        constexpr bool hasCollisions(const std::array<FieldId, FieldCount>& ids) noexcept
+        {
+            for (size_t i = 0; i < FieldCount; ++i)
+            {
+                if (std::count(ids.begin() + i + 1, ids.end(), ids[i]) > 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // the ids of the fields of a struct and the table that finds them
+        template <class FieldId, size_t FieldCount>
+        struct FieldKeys final
+        {
+            std::array<FieldId, FieldCount> ids;
+            bool collides;
+            FieldTable<FieldCount> table;
+        };
+    }
+}
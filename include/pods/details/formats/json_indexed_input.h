@@ -0,0 +1,820 @@
+﻿#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../base64.h"
+#include "../field_table.h"
+#include "../json_index.h"
+#include "../serialization_traits.h"
+#include "../utils.h"
+
+#include "../../errors.h"
+#include "../../types.h"
+
+namespace pods
+{
+    namespace details
+    {
+        // reads json from a contiguous storage: the structural index of the whole buffer
+        // is built with simd first, then the loaders jump from one structural char to the next,
+        // the calls and the results are the same as of JsonInput
+        template <class Storage>
+        class JsonIndexedInput final
+        {
+            static_assert(IsContiguousStorage<Storage>::value,
+                "The structural index can only be built over a contiguous storage");
+
+            // what may follow the last read token
+            enum class Expect
+            {
+                Value,
+                ItemOrEnd,
+                CommaOrEnd
+            };
+
+        public:
+            using Traits = JsonTraits;
+
+            // the keys of an object may come in any order
+            static constexpr bool KeyedObjects = true;
+
+            // skipValue() is able to skip an object
+            static constexpr bool SelfDescribingObjects = true;
+
+            explicit JsonIndexedInput(Storage& storage)
+                : storage_(storage)
+            {
+            }
+
+            JsonIndexedInput(const JsonIndexedInput&) = delete;
+            JsonIndexedInput& operator=(const JsonIndexedInput&) = delete;
+
+            Error startDeserialization()
+            {
+                if (!indexed_)
+                {
+                    PODS_SAFE_CALL(buildIndex());
+                }
+
+                isEndOfObject_ = false;
+                return startObject();
+            }
+
+            Error endDeserialization()
+            {
+                return isEndOfObject_
+                    ? Error::NoError
+                    : endObject();
+            }
+
+            static constexpr std::string_view fieldId(const char* name) noexcept
+            {
+                return getName(name);
+            }
+
+            static constexpr uint32_t fieldHash(std::string_view id) noexcept
+            {
+                return hashName(id);
+            }
+
+            // the id is valid until the next key is loaded,
+            // returns EndOfObject after the last field of the object
+            Error loadFieldId(std::string_view& id)
+            {
+                const auto error = nextItem(true);
+                if (error == Error::EndOfObject)
+                {
+                    isEndOfObject_ = true;
+                    return error;
+                }
+
+                PODS_SAFE_CALL(error);
+                return loadName(id);
+            }
+
+            Error startObject()
+            {
+                PODS_SAFE_CALL(nextItem(false));
+                return open('{');
+            }
+
+            Error endObject()
+            {
+                return nextItem(true) == Error::EndOfObject
+                    ? Error::NoError
+                    : Error::CorruptedArchive;
+            }
+
+            Error startArray()
+            {
+                PODS_SAFE_CALL(nextItem(false));
+                return open('[');
+            }
+
+            Error endArray()
+            {
+                return nextItem(false) == Error::EndOfArray
+                    ? Error::NoError
+                    : Error::CorruptedArchive;
+            }
+
+            Error startMap()
+            {
+                return startObject();
+            }
+
+            Error endMap()
+            {
+                return endObject();
+            }
+
+            Error loadKey(std::string& key)
+            {
+                PODS_SAFE_CALL(nextItem(true));
+
+                std::string_view name;
+                PODS_SAFE_CALL(loadName(name));
+                key.assign(name.data(), name.size());
+                return Error::NoError;
+            }
+
+            template <class T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+            Error load(T& value)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                const auto begin = current();
+                const char* end = nullptr;
+                bool isInteger = false;
+                if (!scanNumber(begin, end, isInteger))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                double number = 0;
+                const auto result = std::from_chars(begin, end, number);
+                if (result.ec != std::errc() || result.ptr != end)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                if (number < std::numeric_limits<T>::lowest() || number > std::numeric_limits<T>::max())
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                value = static_cast<T>(number);
+                return endScalar();
+            }
+
+            template <class T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+            Error load(T& value)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                auto p = current();
+
+                const bool negative = *p == '-';
+                if (negative)
+                {
+                    ++p;
+                }
+
+                if (p == end_ || !isDigit(*p) || (*p == '0' && p + 1 != end_ && isDigit(p[1])))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                uint64_t n = 0;
+                for (; p != end_ && isDigit(*p); ++p)
+                {
+                    const auto digit = static_cast<uint64_t>(*p - '0');
+                    if (n > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                    {
+                        return Error::CorruptedArchive;
+                    }
+                    n = n * 10 + digit;
+                }
+
+                // a fraction or an exponent is a float
+                if (p != end_ && isScalar(*p))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                if (negative)
+                {
+                    constexpr auto MaxNegative = uint64_t(std::numeric_limits<int64_t>::max()) + 1;
+                    if (n > MaxNegative)
+                    {
+                        return Error::CorruptedArchive;
+                    }
+
+                    const auto signedN = n == MaxNegative
+                        ? std::numeric_limits<int64_t>::min()
+                        : -static_cast<int64_t>(n);
+
+                    if (!std::in_range<T>(signedN))
+                    {
+                        return Error::CorruptedArchive;
+                    }
+
+                    value = static_cast<T>(signedN);
+                }
+                else
+                {
+                    if (!std::in_range<T>(n))
+                    {
+                        return Error::CorruptedArchive;
+                    }
+
+                    value = static_cast<T>(n);
+                }
+
+                return endScalar();
+            }
+
+            Error load(bool& value)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                if (isLiteral("true"))
+                {
+                    value = true;
+                }
+                else if (isLiteral("false"))
+                {
+                    value = false;
+                }
+                else
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                return endScalar();
+            }
+
+            Error load(std::string& value)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                std::string_view str;
+                PODS_SAFE_CALL(loadString(str, value));
+                if (str.data() != value.data())
+                {
+                    value.assign(str.data(), str.size());
+                }
+
+                endValue();
+                return Error::NoError;
+            }
+
+            Error loadBlob(char* data, size_t size)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                std::string buffer;
+                std::string_view encoded;
+                PODS_SAFE_CALL(loadString(encoded, buffer));
+                endValue();
+
+                const auto decodedSize = details::getBase64DecodedSize(encoded.data(), encoded.size());
+                if (decodedSize != size)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                details::base64Decode(encoded.data(), encoded.size(), data);
+                return Error::NoError;
+            }
+
+            template <class Allocator>
+            Error loadBlob(const Allocator& allocator)
+            {
+                PODS_SAFE_CALL(nextItem(false));
+
+                std::string buffer;
+                std::string_view encoded;
+                PODS_SAFE_CALL(loadString(encoded, buffer));
+                endValue();
+
+                const auto decodedSize = details::getBase64DecodedSize(encoded.data(), encoded.size());
+                PODS_SAFE_CALL(checkSize(decodedSize));
+                char* data = nullptr;
+                PODS_SAFE_CALL(allocator(data, static_cast<Size>(decodedSize)));
+
+                details::base64Decode(encoded.data(), encoded.size(), data);
+                return Error::NoError;
+            }
+
+            // the strings are not unescaped, only the structure is checked
+            Error skipValue()
+            {
+                if (nextItem(false) != Error::NoError)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                const auto depth = containers_.size();
+
+                PODS_SAFE_CALL(skipItem());
+
+                while (containers_.size() > depth)
+                {
+                    const bool isObject = containers_.back() == '{';
+
+                    const auto error = nextItem(isObject);
+                    if (error == Error::EndOfObject || error == Error::EndOfArray)
+                    {
+                        continue;
+                    }
+
+                    PODS_SAFE_CALL(error);
+
+                    if (isObject)
+                    {
+                        PODS_SAFE_CALL(skipString());
+                        PODS_SAFE_CALL(take(':'));
+                        expect_ = Expect::Value;
+                    }
+
+                    PODS_SAFE_CALL(skipItem());
+                }
+
+                return Error::NoError;
+            }
+
+        private:
+            Error buildIndex()
+            {
+                size_t size = storage_.available();
+                if (size > std::numeric_limits<uint32_t>::max())
+                {
+                    return Error::InvalidSize;
+                }
+
+                PODS_SAFE_CALL(storage_.view(begin_, 0));
+                end_ = begin_ + size;
+
+                if (!buildJsonIndex(begin_, size, index_, hasBackslashes_))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                indexed_ = true;
+                return Error::NoError;
+            }
+
+            const char* current() const noexcept
+            {
+                return begin_ + index_[pos_];
+            }
+
+            static bool isDigit(char c) noexcept
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            // a char of a number or a literal
+            static bool isScalar(char c) noexcept
+            {
+                switch (c)
+                {
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                case '"':
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    return false;
+                default:
+                    return true;
+                }
+            }
+
+            // goes to the next item of the current container (a key of an object)
+            // or leaves the container and returns EndOfArray or EndOfObject
+            Error nextItem(bool isKey)
+            {
+                if (pos_ == index_.size())
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                if (expect_ == Expect::Value)
+                {
+                    return isKey
+                        ? Error::CorruptedArchive
+                        : Error::NoError;
+                }
+
+                auto c = *current();
+
+                if (expect_ == Expect::CommaOrEnd && c == ',')
+                {
+                    if (++pos_ == index_.size())
+                    {
+                        return Error::CorruptedArchive;
+                    }
+
+                    c = *current();
+                    if (c == '}' || c == ']')
+                    {
+                        return Error::CorruptedArchive;
+                    }
+                }
+                else if (c == '}' || c == ']')
+                {
+                    if (containers_.back() != (c == '}' ? '{' : '['))
+                    {
+                        return Error::CorruptedArchive;
+                    }
+
+                    ++pos_;
+                    containers_.pop_back();
+                    endValue();
+
+                    return c == '}'
+                        ? Error::EndOfObject
+                        : Error::EndOfArray;
+                }
+                else if (expect_ == Expect::CommaOrEnd)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                if (isKey != (containers_.back() == '{'))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                expect_ = Expect::Value;
+                return Error::NoError;
+            }
+
+            Error open(char bracket)
+            {
+                if (*current() != bracket)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                ++pos_;
+                containers_.push_back(bracket);
+                expect_ = Expect::ItemOrEnd;
+                return Error::NoError;
+            }
+
+            Error take(char c) noexcept
+            {
+                if (pos_ == index_.size() || *current() != c)
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                ++pos_;
+                return Error::NoError;
+            }
+
+            // a complete value is read, the storage is moved past the root value
+            void endValue()
+            {
+                if (!containers_.empty())
+                {
+                    expect_ = Expect::CommaOrEnd;
+                    return;
+                }
+
+                expect_ = Expect::Value;
+
+                const auto offset = pos_ < index_.size()
+                    ? index_[pos_]
+                    : static_cast<size_t>(end_ - begin_);
+
+                const char* unused = nullptr;
+                storage_.view(unused, offset - committed_);
+                committed_ = offset;
+            }
+
+            Error endScalar()
+            {
+                ++pos_;
+                endValue();
+                return Error::NoError;
+            }
+
+            // the chars of the literal are followed by a delimiter
+            bool isLiteral(std::string_view literal) const noexcept
+            {
+                const auto begin = current();
+                return static_cast<size_t>(end_ - begin) >= literal.size()
+                    && memcmp(begin, literal.data(), literal.size()) == 0
+                    && (begin + literal.size() == end_ || !isScalar(begin[literal.size()]));
+            }
+
+            // checks the grammar of a json number
+            bool scanNumber(const char* begin, const char*& end, bool& isInteger) const noexcept
+            {
+                auto p = begin;
+
+                const auto digits = [this, &p]()
+                {
+                    const auto first = p;
+                    while (p != end_ && isDigit(*p))
+                    {
+                        ++p;
+                    }
+                    return p != first;
+                };
+
+                if (p != end_ && *p == '-')
+                {
+                    ++p;
+                }
+
+                if (p != end_ && *p == '0')
+                {
+                    ++p;
+                }
+                else if (!digits())
+                {
+                    return false;
+                }
+
+                isInteger = true;
+
+                if (p != end_ && *p == '.')
+                {
+                    ++p;
+                    isInteger = false;
+                    if (!digits())
+                    {
+                        return false;
+                    }
+                }
+
+                if (p != end_ && (*p == 'e' || *p == 'E'))
+                {
+                    ++p;
+                    isInteger = false;
+                    if (p != end_ && (*p == '+' || *p == '-'))
+                    {
+                        ++p;
+                    }
+                    if (!digits())
+                    {
+                        return false;
+                    }
+                }
+
+                end = p;
+                return p == end_ || !isScalar(*p);
+            }
+
+            Error loadName(std::string_view& name)
+            {
+                PODS_SAFE_CALL(loadString(name, name_));
+                PODS_SAFE_CALL(take(':'));
+                expect_ = Expect::Value;
+                return Error::NoError;
+            }
+
+            // points the value into the buffer if the string has no escapes,
+            // otherwise unescapes the string to the buffer
+            Error loadString(std::string_view& value, std::string& buffer)
+            {
+                if (*current() != '"')
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                // the closing quote always follows the opening one in the index
+                const auto begin = current() + 1;
+                const auto end = begin_ + index_[pos_ + 1];
+                pos_ += 2;
+
+                const auto size = static_cast<size_t>(end - begin);
+
+                if (!hasBackslashes_ || memchr(begin, '\\', size) == nullptr)
+                {
+                    value = std::string_view(begin, size);
+                    return Error::NoError;
+                }
+
+                if (!unescape(begin, end, buffer))
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                value = buffer;
+                return Error::NoError;
+            }
+
+            static bool loadHex(const char*& p, const char* end, uint32_t& code) noexcept
+            {
+                if (end - p < 4)
+                {
+                    return false;
+                }
+
+                code = 0;
+                for (int i = 0; i < 4; ++i, ++p)
+                {
+                    const auto c = *p;
+                    code <<= 4;
+                    if (c >= '0' && c <= '9')
+                    {
+                        code |= static_cast<uint32_t>(c - '0');
+                    }
+                    else if (c >= 'a' && c <= 'f')
+                    {
+                        code |= static_cast<uint32_t>(c - 'a' + 10);
+                    }
+                    else if (c >= 'A' && c <= 'F')
+                    {
+                        code |= static_cast<uint32_t>(c - 'A' + 10);
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            static void appendUtf8(uint32_t code, std::string& out)
+            {
+                if (code < 0x80)
+                {
+                    out.push_back(static_cast<char>(code));
+                }
+                else if (code < 0x800)
+                {
+                    out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else if (code < 0x10000)
+                {
+                    out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+            }
+
+            static bool unescape(const char* p, const char* end, std::string& out)
+            {
+                out.clear();
+
+                while (p != end)
+                {
+                    const auto escape = static_cast<const char*>(memchr(p, '\\', static_cast<size_t>(end - p)));
+                    if (escape == nullptr)
+                    {
+                        out.append(p, end);
+                        return true;
+                    }
+
+                    out.append(p, escape);
+                    p = escape + 1;
+
+                    if (p == end)
+                    {
+                        return false;
+                    }
+
+                    switch (*p++)
+                    {
+                    case '"': out.push_back('"'); break;
+                    case '\\': out.push_back('\\'); break;
+                    case '/': out.push_back('/'); break;
+                    case 'b': out.push_back('\b'); break;
+                    case 'f': out.push_back('\f'); break;
+                    case 'n': out.push_back('\n'); break;
+                    case 'r': out.push_back('\r'); break;
+                    case 't': out.push_back('\t'); break;
+                    case 'u':
+                    {
+                        uint32_t code = 0;
+                        if (!loadHex(p, end, code) || (code >= 0xDC00 && code <= 0xDFFF))
+                        {
+                            return false;
+                        }
+
+                        // a surrogate pair
+                        if (code >= 0xD800 && code <= 0xDBFF)
+                        {
+                            uint32_t low = 0;
+                            if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+                            {
+                                return false;
+                            }
+
+                            p += 2;
+                            if (!loadHex(p, end, low) || low < 0xDC00 || low > 0xDFFF)
+                            {
+                                return false;
+                            }
+
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+
+                        appendUtf8(code, out);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            Error skipString()
+            {
+                if (*current() != '"')
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                pos_ += 2;
+                return Error::NoError;
+            }
+
+            // the first token of a value
+            Error skipItem()
+            {
+                if (pos_ == index_.size())
+                {
+                    return Error::CorruptedArchive;
+                }
+
+                switch (*current())
+                {
+                case '{':
+                case '[':
+                    return open(*current());
+                case '"':
+                    PODS_SAFE_CALL(skipString());
+                    endValue();
+                    return Error::NoError;
+                case '}':
+                case ']':
+                case ':':
+                case ',':
+                    return Error::CorruptedArchive;
+                default:
+                    break;
+                }
+
+                const char* end = nullptr;
+                bool isInteger = false;
+                if (isLiteral("true") || isLiteral("false") || isLiteral("null")
+                    || scanNumber(current(), end, isInteger))
+                {
+                    return endScalar();
+                }
+
+                return Error::CorruptedArchive;
+            }
+
+        private:
+            Storage& storage_;
+
+            const char* begin_ = nullptr;
+            const char* end_ = nullptr;
+
+            std::vector<uint32_t> index_;
+            size_t pos_ = 0;
+            size_t committed_ = 0;
+            bool indexed_ = false;
+            bool hasBackslashes_ = false;
+
+            // the open objects and arrays
+            std::vector<char> containers_;
+            Expect expect_ = Expect::Value;
+
+            std::string name_;
+            bool isEndOfObject_ = false;
+        };
+    }
+}
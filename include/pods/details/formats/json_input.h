@@ -1,12 +1,15 @@
 ﻿#pragma once
 
 #include <cassert>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
 #include <rapidjson/reader.h>
 
 #include "../base64.h"
+#include "../field_table.h"
 #include "../rapidjson_wrappers.h"
 #include "../serialization_traits.h"
 #include "../utils.h"
@@ -90,6 +93,17 @@ namespace pods
             }
         };
 
+        // the in-situ strings point into the parsed buffer, so a view is enough
+        inline void assignString(std::string& to, const char* str, rapidjson::SizeType length)
+        {
+            to.assign(str, length);
+        }
+
+        inline void assignString(std::string_view& to, const char* str, rapidjson::SizeType length) noexcept
+        {
+            to = std::string_view(str, length);
+        }
+
         template <class Tag, class Data>
         struct Handler final
         {
@@ -212,7 +226,7 @@ namespace pods
             {
                 if constexpr (std::is_same<Tag, StringTag>::value)
                 {
-                    data_.value_.assign(str, length);
+                    assignString(data_.value_, str, length);
                     return true;
                 }
                 else
@@ -238,7 +252,7 @@ namespace pods
                 if constexpr (std::is_same<Tag, KeyTag>::value
                     || std::is_same<Tag, KeyTag>::value)
                 {
-                    data_.value_.assign(str, length);
+                    assignString(data_.value_, str, length);
                     return true;
                 }
                 else
@@ -302,20 +316,81 @@ namespace pods
             Data data_;
         };
 
-        template <class Storage>
+        // accepts any value, counts the nesting of the objects and the arrays
+        struct SkipHandler final
+        {
+            using DataT = EmptyData;
+
+            explicit SkipHandler(size_t& depth) noexcept
+                : depth_(depth)
+            {
+            }
+
+            bool Null() noexcept { return true; }
+            bool Bool(bool) noexcept { return true; }
+            bool Int(int) noexcept { return true; }
+            bool Uint(unsigned) noexcept { return true; }
+            bool Int64(int64_t) noexcept { return true; }
+            bool Uint64(uint64_t) noexcept { return true; }
+            bool Double(double) noexcept { return true; }
+            bool RawNumber(const char*, rapidjson::SizeType, bool) noexcept { return true; }
+            bool String(const char*, rapidjson::SizeType, bool) noexcept { return true; }
+            bool Key(const char*, rapidjson::SizeType, bool) noexcept { return true; }
+
+            bool StartObject() noexcept
+            {
+                ++depth_;
+                return true;
+            }
+
+            bool EndObject(rapidjson::SizeType) noexcept
+            {
+                return depth_-- > 0;
+            }
+
+            bool StartArray() noexcept
+            {
+                ++depth_;
+                return true;
+            }
+
+            bool EndArray(rapidjson::SizeType) noexcept
+            {
+                return depth_-- > 0;
+            }
+
+            size_t& depth_;
+        };
+
+        // Insitu decodes the strings in place (rapidjson::kParseInsituFlag),
+        // the storage has to give writable memory, see InsituInputBuffer
+        template <class Storage, bool Insitu = false>
         class JsonInput final
         {
+            static constexpr unsigned ParseFlags = Insitu
+                ? rapidjson::kParseInsituFlag
+                : rapidjson::kParseDefaultFlags;
+
+            // the strings of an in-situ archive are not copied
+            using StringT = std::conditional_t<Insitu, std::string_view, std::string>;
+
         public:
             using Traits = JsonTraits;
 
+            // the keys of an object may come in any order
+            static constexpr bool KeyedObjects = true;
+
+            // skipValue() is able to skip an object
+            static constexpr bool SelfDescribingObjects = true;
+
             explicit JsonInput(Storage& storage)
                 : stream_(storage)
             {
                 reader_.IterativeParseInit();
             }
 
-            JsonInput(const JsonInput<Storage>&) = delete;
-            JsonInput& operator=(const JsonInput<Storage>&) = delete;
+            JsonInput(const JsonInput&) = delete;
+            JsonInput& operator=(const JsonInput&) = delete;
 
             Error startDeserialization()
             {
@@ -330,32 +405,32 @@ namespace pods
                     : endObject();
             }
 
-            Error checkName(const char* name)
+            static constexpr std::string_view fieldId(const char* name) noexcept
             {
-                if (name_.empty())
-                {
-                    Handler<KeyTag, ValueAndIsEndOfObjectData<std::string>> handler(name_);
-                    PODS_SAFE_CALL(parseNext(handler));
-
-                    isEndOfObject_ = handler.data_.isEndOfObject_;
+                return getName(name);
+            }
 
-                    if (isEndOfObject_)
-                    {
-                        return isOptional(name)
-                            ? Error::OptionalFieldMissed
-                            : Error::MandatoryFieldMissed;
-                    }
-                }
+            static constexpr uint32_t fieldHash(std::string_view id) noexcept
+            {
+                return hashName(id);
+            }
 
-                if (strcmp(name_.c_str(), getName(name)) == 0)
+            // the id is valid until the next key is loaded,
+            // returns EndOfObject after the last field of the object
+            Error loadFieldId(std::string_view& id)
+            {
+                Handler<KeyTag, ValueAndIsEndOfObjectData<StringT>> handler(name_);
+                const auto error = parseNext(handler);
+                if (error == Error::EndOfObject)
                 {
-                    name_.clear();
-                    return Error::NoError;
+                    isEndOfObject_ = true;
+                    return error;
                 }
 
-                return isOptional(name)
-                    ? Error::OptionalFieldMissed
-                    : Error::MandatoryFieldMissed;
+                PODS_SAFE_CALL(error);
+
+                id = name_;
+                return Error::NoError;
             }
 
             Error startObject()
@@ -424,33 +499,53 @@ namespace pods
                 return parseNext(handler);
             }
 
+            Error load(std::string_view& value)
+            {
+                static_assert(Insitu,
+                    "std::string_view can only be loaded by the in-situ deserializer");
+
+                Handler<StringTag, ValueAndIsEndOfArrayData<std::string_view>> handler(value);
+                return parseNext(handler);
+            }
+
             Error loadBlob(char* data, size_t size)
             {
-                std::string encoded;
+                StringT encoded;
                 PODS_SAFE_CALL(load(encoded));
 
-                const auto decodedSize = details::getBase64DecodedSize(encoded.c_str(), encoded.size());
+                const auto decodedSize = details::getBase64DecodedSize(encoded.data(), encoded.size());
                 if (decodedSize != size)
                 {
                     return Error::CorruptedArchive;
                 }
 
-                details::base64Decode(encoded.c_str(), encoded.size(), data);
+                details::base64Decode(encoded.data(), encoded.size(), data);
                 return Error::NoError;
             }
 
             template <class Allocator>
             Error loadBlob(const Allocator& allocator)
             {
-                std::string encoded;
+                StringT encoded;
                 PODS_SAFE_CALL(load(encoded));
 
-                const auto decodedSize = details::getBase64DecodedSize(encoded.c_str(), encoded.size());
+                const auto decodedSize = details::getBase64DecodedSize(encoded.data(), encoded.size());
                 PODS_SAFE_CALL(checkSize(decodedSize));
                 char* data = nullptr;
                 PODS_SAFE_CALL(allocator(data, static_cast<Size>(decodedSize)));
 
-                details::base64Decode(encoded.c_str(), encoded.size(), data);
+                details::base64Decode(encoded.data(), encoded.size(), data);
+                return Error::NoError;
+            }
+
+            Error skipValue()
+            {
+                size_t depth = 0;
+                do
+                {
+                    PODS_SAFE_CALL(parseNext(SkipHandler(depth)));
+                } while (depth > 0);
+
                 return Error::NoError;
             }
 
@@ -458,7 +553,14 @@ namespace pods
             template <class Handler>
             Error parseNext(Handler handler)
             {
-                if (reader_.IterativeParseNext<rapidjson::kParseDefaultFlags>(stream_, handler))
+                const auto parsed = reader_.IterativeParseNext<ParseFlags>(stream_, handler);
+
+                if constexpr (IsContiguousStorage<Storage>::value)
+                {
+                    stream_.commit();
+                }
+
+                if (parsed)
                 {
                     if constexpr (std::is_base_of<IsEndOfArrayData, Handler::DataT>::value
                         && std::is_base_of<IsEndOfObjectData, Handler::DataT>::value)
@@ -498,10 +600,15 @@ namespace pods
             }
 
         private:
-            InputRapidJsonStreamWrapper<Storage> stream_;
+            // the wrapper reads a stream char by char
+            std::conditional_t<Insitu,
+                InputRapidJsonInsituStream<Storage>,
+                std::conditional_t<IsContiguousStorage<Storage>::value,
+                    InputRapidJsonMemoryStream<Storage>,
+                    InputRapidJsonStreamWrapper<Storage>>> stream_;
             rapidjson::Reader reader_;
 
-            std::string name_;
+            StringT name_;
             bool isEndOfObject_;
         };
     }
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <limits>
+#include <string_view>
+
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/writer.h>
 
@@ -49,6 +52,11 @@ namespace pods
                     : Error::WriteError;
             }
 
+            Error saveFieldCount(Size /*count*/) noexcept
+            {
+                return Error::NoError;
+            }
+
             Error saveKey(const char* value)
             {
                 return saveName(value);
@@ -134,9 +142,14 @@ namespace pods
                     : Error::WriteError;
             }
 
-            Error save(const std::string& value)
+            Error save(std::string_view value)
             {
-                return writer_.String(value.c_str(), static_cast<rapidjson::SizeType>(value.length())) && stream_.good()
+                if (value.length() > std::numeric_limits<rapidjson::SizeType>::max())
+                {
+                    return Error::InvalidSize;
+                }
+
+                return writer_.String(value.data(), static_cast<rapidjson::SizeType>(value.length())) && stream_.good()
                     ? Error::NoError
                     : Error::WriteError;
             }
@@ -149,7 +162,8 @@ namespace pods
             }
 
         private:
-            OutputRapidJsonStreamWrapper<Storage> stream_;
+            // the bulk stream writes to the memory of a contiguous storage
+            OutputRapidJsonStream<Storage> stream_;
             RapidjsonWriter writer_;
         };
     }
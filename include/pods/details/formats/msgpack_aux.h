@@ -1,6 +1,12 @@
 ﻿#pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "../utils.h"
 
 namespace pods
 {
@@ -10,6 +16,8 @@ namespace pods
         {
             using Tag = uint8_t;
 
+            static constexpr Tag Nil = 0xc0;
+
             static constexpr Tag True = 0xc3;
             static constexpr Tag False = 0xc2;
 
@@ -40,6 +48,16 @@ namespace pods
             static constexpr Tag Bin16 = 0xc5;
             static constexpr Tag Bin32 = 0xc6;
 
+            static constexpr Tag Ext8 = 0xc7;
+            static constexpr Tag Ext16 = 0xc8;
+            static constexpr Tag Ext32 = 0xc9;
+
+            static constexpr Tag FixExt1 = 0xd4;
+            static constexpr Tag FixExt2 = 0xd5;
+            static constexpr Tag FixExt4 = 0xd6;
+            static constexpr Tag FixExt8 = 0xd7;
+            static constexpr Tag FixExt16 = 0xd8;
+
             static constexpr Tag ArrayMax = 15;
             static constexpr Tag ArrayMask = 0b10010000;
             static constexpr Tag ArrayValue = 0b00001111;
@@ -69,6 +87,215 @@ namespace pods
             static constexpr uint16_t Max16U = std::numeric_limits<uint16_t>::max();
             static constexpr uint32_t Max32U = std::numeric_limits<uint32_t>::max();
             static constexpr uint64_t Max64U = std::numeric_limits<uint64_t>::max();
+
+            // the encoding policies of MsgPackOutput, both produce valid msgpack
+
+            // the smallest encoding of every value
+            struct CompactEncoding
+            {
+                static constexpr bool FixedWidth = false;
+                static constexpr bool FramedObjects = false;
+                static constexpr bool KeyedObjects = false;
+            };
+
+            // every value takes the full width of its C++ type and every size takes
+            // 32 bits, so there are no branches and the layout of a struct is fixed
+            struct FixedWidthEncoding
+            {
+                static constexpr bool FixedWidth = true;
+                static constexpr bool FramedObjects = false;
+                static constexpr bool KeyedObjects = false;
+            };
+
+            // every struct is an array of its fields, so a reader is able to skip
+            // the fields it does not know and to notice the missing ones
+            template <class Base = CompactEncoding>
+            struct FramedEncoding
+                : Base
+            {
+                static constexpr bool FramedObjects = true;
+            };
+
+            // every struct is a map from the ids of its fields to the values, so a reader
+            // accepts the fields in any order, skips the unknown ones and notices the missing ones
+            template <class Base = CompactEncoding>
+            struct KeyedEncoding
+                : Base
+            {
+                static constexpr bool KeyedObjects = true;
+            };
+
+            using FieldId = uint16_t;
+
+            // FNV-1a of the name folded to 16 bits, the ids of a struct are computed
+            // once by the serializer and the deserializer, 7 bits would be
+            // a fixint, but would collide in every third struct with 10 fields
+            constexpr FieldId fieldId(const char* name) noexcept
+            {
+                uint32_t hash = 2166136261u;
+                for (auto c = getName(name); *c != 0; ++c)
+                {
+                    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+                }
+                return static_cast<FieldId>((hash >> 16) ^ hash);
+            }
+
+            // how to jump over a value by its tag
+            struct Skip
+            {
+                enum Kind : uint8_t
+                {
+                    Invalid,
+                    Bytes,      // size bytes follow the tag
+                    SizedBytes, // the length takes size bytes (0 - in the tag), extra bytes precede the data
+                    Array,      // the number of the items takes size bytes (0 - in the tag)
+                    Map         // the number of the pairs takes size bytes (0 - in the tag)
+                };
+
+                Kind kind;
+                uint8_t size;
+                uint8_t extra;
+            };
+
+            constexpr std::array<Skip, 256> makeSkipTable() noexcept
+            {
+                std::array<Skip, 256> table {};
+
+                for (size_t i = 0; i <= Max7U; ++i)
+                {
+                    table[i] = { Skip::Bytes, 0, 0 };
+                }
+
+                for (size_t i = 0xe0; i <= Max8U; ++i)
+                {
+                    table[i] = { Skip::Bytes, 0, 0 };
+                }
+
+                for (size_t i = 0; i <= MapValue; ++i)
+                {
+                    table[MapMask | i] = { Skip::Map, 0, 0 };
+                }
+
+                for (size_t i = 0; i <= ArrayValue; ++i)
+                {
+                    table[ArrayMask | i] = { Skip::Array, 0, 0 };
+                }
+
+                for (size_t i = 0; i <= StrValue; ++i)
+                {
+                    table[StrMask | i] = { Skip::SizedBytes, 0, 0 };
+                }
+
+                table[Nil] = { Skip::Bytes, 0, 0 };
+                table[False] = { Skip::Bytes, 0, 0 };
+                table[True] = { Skip::Bytes, 0, 0 };
+
+                table[Int8] = { Skip::Bytes, 1, 0 };
+                table[UInt8] = { Skip::Bytes, 1, 0 };
+                table[Int16] = { Skip::Bytes, 2, 0 };
+                table[UInt16] = { Skip::Bytes, 2, 0 };
+                table[Int32] = { Skip::Bytes, 4, 0 };
+                table[UInt32] = { Skip::Bytes, 4, 0 };
+                table[Int64] = { Skip::Bytes, 8, 0 };
+                table[UInt64] = { Skip::Bytes, 8, 0 };
+                table[Float] = { Skip::Bytes, 4, 0 };
+                table[Double] = { Skip::Bytes, 8, 0 };
+
+                table[Str8] = { Skip::SizedBytes, 1, 0 };
+                table[Str16] = { Skip::SizedBytes, 2, 0 };
+                table[Str32] = { Skip::SizedBytes, 4, 0 };
+                table[Bin8] = { Skip::SizedBytes, 1, 0 };
+                table[Bin16] = { Skip::SizedBytes, 2, 0 };
+                table[Bin32] = { Skip::SizedBytes, 4, 0 };
+                table[Ext8] = { Skip::SizedBytes, 1, 1 };
+                table[Ext16] = { Skip::SizedBytes, 2, 1 };
+                table[Ext32] = { Skip::SizedBytes, 4, 1 };
+
+                table[FixExt1] = { Skip::Bytes, 2, 0 };
+                table[FixExt2] = { Skip::Bytes, 3, 0 };
+                table[FixExt4] = { Skip::Bytes, 5, 0 };
+                table[FixExt8] = { Skip::Bytes, 9, 0 };
+                table[FixExt16] = { Skip::Bytes, 17, 0 };
+
+                table[Array16] = { Skip::Array, 2, 0 };
+                table[Array32] = { Skip::Array, 4, 0 };
+                table[Map16] = { Skip::Map, 2, 0 };
+                table[Map32] = { Skip::Map, 4, 0 };
+
+                return table;
+            }
+
+            static constexpr std::array<Skip, 256> SkipTable = makeSkipTable();
+
+            // the types that have their own msgpack encodings
+            template <class T>
+            struct IsNumber
+                : std::integral_constant<bool,
+                    std::is_same<T, int8_t>::value || std::is_same<T, uint8_t>::value ||
+                    std::is_same<T, int16_t>::value || std::is_same<T, uint16_t>::value ||
+                    std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+                    std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value ||
+                    std::is_same<T, float>::value || std::is_same<T, double>::value>
+            {
+            };
+
+            // the integer type of the next narrower encoding
+            template <class T>
+            struct Narrower;
+
+            template <>
+            struct Narrower<int16_t>
+            {
+                using type = int8_t;
+            };
+
+            template <>
+            struct Narrower<uint16_t>
+            {
+                using type = uint8_t;
+            };
+
+            template <>
+            struct Narrower<int32_t>
+            {
+                using type = int16_t;
+            };
+
+            template <>
+            struct Narrower<uint32_t>
+            {
+                using type = uint16_t;
+            };
+
+            template <>
+            struct Narrower<int64_t>
+            {
+                using type = int32_t;
+            };
+
+            template <>
+            struct Narrower<uint64_t>
+            {
+                using type = uint32_t;
+            };
+
+            // the tag of the encoding that takes all bytes of the type
+            template <class T>
+            constexpr Tag widestTag() noexcept
+            {
+                if constexpr (std::is_floating_point<T>::value)
+                {
+                    return sizeof(T) == sizeof(float) ? Float : Double;
+                }
+                else if constexpr (std::is_signed<T>::value)
+                {
+                    return sizeof(T) == 1 ? Int8 : sizeof(T) == 2 ? Int16 : sizeof(T) == 4 ? Int32 : Int64;
+                }
+                else
+                {
+                    return sizeof(T) == 1 ? UInt8 : sizeof(T) == 2 ? UInt16 : sizeof(T) == 4 ? UInt32 : UInt64;
+                }
+            }
         }
     }
 }
@@ -1,5 +1,14 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 #include "../endianness.h"
 #include "../serialization_traits.h"
 #include "../utils.h"
@@ -13,32 +22,104 @@ namespace pods
 {
     namespace details
     {
-        template <class Storage>
+        template <class Storage, class Encoding = msgpack::CompactEncoding>
         class MsgPackInput final
         {
+            static_assert(!(Encoding::FramedObjects && Encoding::KeyedObjects),
+                "A struct is either an array or a map");
+
         public:
             using Traits = MsgPackTraits;
 
+            static constexpr bool KeyedObjects = Encoding::KeyedObjects;
+
+            // skipValue() is able to skip a struct
+            static constexpr bool SelfDescribingObjects = Encoding::FramedObjects || Encoding::KeyedObjects;
+
             explicit MsgPackInput(Storage& storage) noexcept
                 : storage_(storage)
             {
             }
 
-            MsgPackInput(const MsgPackInput<Storage>&) = delete;
-            MsgPackInput& operator=(const MsgPackInput<Storage>&) = delete;
+            MsgPackInput(const MsgPackInput&) = delete;
+            MsgPackInput& operator=(const MsgPackInput&) = delete;
 
-            Error startDeserialization() noexcept
+            Error startDeserialization()
             {
+                if constexpr (Encoding::FramedObjects)
+                {
+                    Size size = 0;
+                    PODS_SAFE_CALL(startArray(size));
+                    fields_.push_back(size);
+                }
+                else if constexpr (Encoding::KeyedObjects)
+                {
+                    Size size = 0;
+                    PODS_SAFE_CALL(startMap(size));
+                    fields_.push_back(size);
+                }
                 return Error::NoError;
             }
 
-            Error endDeserialization() noexcept
+            Error endDeserialization()
             {
+                if constexpr (Encoding::FramedObjects)
+                {
+                    // the fields that the struct does not know
+                    for (auto rest = fields_.back(); rest > 0; --rest)
+                    {
+                        PODS_SAFE_CALL(skipValue());
+                    }
+                    fields_.pop_back();
+                }
+                else if constexpr (Encoding::KeyedObjects)
+                {
+                    for (auto rest = fields_.back(); rest > 0; --rest)
+                    {
+                        PODS_SAFE_CALL(skipValue());
+                        PODS_SAFE_CALL(skipValue());
+                    }
+                    fields_.pop_back();
+                }
                 return Error::NoError;
             }
 
-            Error checkName(const char*) noexcept
+            static constexpr msgpack::FieldId fieldId(const char* name) noexcept
+            {
+                return msgpack::fieldId(name);
+            }
+
+            // the id is a hash already
+            static constexpr uint32_t fieldHash(msgpack::FieldId id) noexcept
+            {
+                return id;
+            }
+
+            // the keyed mode, returns EndOfObject after the last field of the struct
+            Error loadFieldId(msgpack::FieldId& id)
             {
+                auto& rest = fields_.back();
+                if (rest == 0)
+                {
+                    return Error::EndOfObject;
+                }
+                --rest;
+                return load(id);
+            }
+
+            Error checkName(const char* name) noexcept
+            {
+                if constexpr (Encoding::FramedObjects)
+                {
+                    auto& rest = fields_.back();
+                    if (rest == 0)
+                    {
+                        return isOptional(name)
+                            ? Error::OptionalFieldMissed
+                            : Error::MandatoryFieldMissed;
+                    }
+                    --rest;
+                }
                 return Error::NoError;
             }
 
@@ -67,8 +148,7 @@ namespace pods
                     return Error::NoError;
                 }
                 case msgpack::Array32:
-                    PODS_SAFE_CALL(storage_.get(size));
-                    return Error::NoError;
+                    return loadSize32(size);
                 }
 
                 if ((tag & ~msgpack::ArrayValue) == msgpack::ArrayMask)
@@ -100,8 +180,7 @@ namespace pods
                     return Error::NoError;
                 }
                 case msgpack::Map32:
-                    PODS_SAFE_CALL(storage_.get(size));
-                    return Error::NoError;
+                    return loadSize32(size);
                 }
 
                 if ((tag & ~msgpack::MapValue) == msgpack::MapMask)
@@ -287,41 +366,24 @@ namespace pods
             Error load(std::string& value)
             {
                 Size size = 0;
-                msgpack::Tag tag;
-                PODS_SAFE_CALL(storage_.get(tag));
-                switch (tag)
-                {
-                case msgpack::Str8:
-                {
-                    uint8_t n = 0;
-                    PODS_SAFE_CALL(storage_.get(n));
-                    size = n;
-                    break;
-                }
-                case msgpack::Str16:
-                {
-                    uint16_t n = 0;
-                    PODS_SAFE_CALL(storage_.get(n));
-                    size = n;
-                    break;
-                }
-                case msgpack::Str32:
-                    PODS_SAFE_CALL(storage_.get(size));
-                    break;
-                default:
-                    if ((tag & ~msgpack::StrValue) == msgpack::StrMask)
-                    {
-                        size = (tag & msgpack::StrValue);
-                    }
-                    else
-                    {
-                        return Error::CorruptedArchive;
-                    }
-                }
+                PODS_SAFE_CALL(loadStringSize(size));
                 value.resize(size);
                 return storage_.get(const_cast<char*>(value.data()), size);
             }
 
+            Error load(std::string_view& value)
+            {
+                static_assert(IsContiguousStorage<Storage>::value,
+                    "std::string_view can only be loaded from a contiguous storage");
+
+                Size size = 0;
+                PODS_SAFE_CALL(loadStringSize(size));
+                const char* data = nullptr;
+                PODS_SAFE_CALL(storage_.view(data, size));
+                value = std::string_view(data, size);
+                return Error::NoError;
+            }
+
             Error loadBlob(char* data, size_t size)
             {
                 Size actualSize = 0;
@@ -341,7 +403,337 @@ namespace pods
                 return storage_.get(data, size);
             }
 
+            Error loadBlob(std::span<const char>& value)
+            {
+                static_assert(IsContiguousStorage<Storage>::value,
+                    "std::span can only be loaded from a contiguous storage");
+
+                Size size = 0;
+                PODS_SAFE_CALL(loadBinarySize(size));
+                const char* data = nullptr;
+                PODS_SAFE_CALL(storage_.view(data, size));
+                value = std::span<const char>(data, size);
+                return Error::NoError;
+            }
+
+            // jumps over the next value whatever it is
+            Error skipValue()
+            {
+                uint64_t pending = 1;
+                while (pending > 0)
+                {
+                    --pending;
+
+                    msgpack::Tag tag;
+                    PODS_SAFE_CALL(storage_.get(tag));
+
+                    const auto skip = msgpack::SkipTable[tag];
+                    switch (skip.kind)
+                    {
+                    case msgpack::Skip::Bytes:
+                        PODS_SAFE_CALL(skipBytes(skip.size));
+                        break;
+                    case msgpack::Skip::SizedBytes:
+                    {
+                        Size size = 0;
+                        PODS_SAFE_CALL(loadLength(tag, skip.size, msgpack::StrValue, size));
+                        PODS_SAFE_CALL(skipBytes(static_cast<size_t>(size) + skip.extra));
+                        break;
+                    }
+                    case msgpack::Skip::Array:
+                    {
+                        Size size = 0;
+                        PODS_SAFE_CALL(loadLength(tag, skip.size, msgpack::ArrayValue, size));
+                        pending += size;
+                        break;
+                    }
+                    case msgpack::Skip::Map:
+                    {
+                        Size size = 0;
+                        PODS_SAFE_CALL(loadLength(tag, skip.size, msgpack::MapValue, size));
+                        pending += 2 * static_cast<uint64_t>(size);
+                        break;
+                    }
+                    default:
+                        return Error::CorruptedArchive;
+                    }
+                }
+
+                return Error::NoError;
+            }
+
+            // loads the items of an array which header is already read, over a contiguous
+            // storage the runs of the items with the same tag are decoded in tight loops
+            template <class T, typename std::enable_if<msgpack::IsNumber<T>::value, int>::type = 0>
+            Error loadArrayItems(T* data, Size size)
+            {
+                size_t i = 0;
+
+                if constexpr (IsContiguousStorage<Storage>::value)
+                {
+                    const char* input = nullptr;
+                    PODS_SAFE_CALL(storage_.view(input, 0));
+
+                    const auto available = storage_.available();
+
+                    size_t pos = 0;
+                    while (i < size)
+                    {
+                        size_t bytes = 0;
+                        const auto count = decodeRun(input + pos, available - pos, data + i, size - i, bytes);
+                        if (count == 0)
+                        {
+                            break;
+                        }
+
+                        pos += bytes;
+                        i += count;
+                    }
+
+                    PODS_SAFE_CALL(storage_.view(input, pos));
+                }
+
+                // the rest has an unexpected tag or is truncated, the usual path reports the error
+                for (; i < size; ++i)
+                {
+                    PODS_SAFE_CALL(load(data[i]));
+                }
+
+                return Error::NoError;
+            }
+
         private:
+            static constexpr uint8_t NotLoadable = 0xff;
+            static constexpr size_t FixIntBlockSize = 16;
+            static constexpr size_t MixedBlockSize = 16;
+
+            // decodes the next items: a run of fixints, a run of the items with the same tag
+            // or a few items with different tags, returns the number of the items and
+            // the number of the bytes they take
+            template <class T>
+            static size_t decodeRun(const char* input, size_t available, T* data, size_t size, size_t& bytes) noexcept
+            {
+                if (available == 0)
+                {
+                    return 0;
+                }
+
+                const auto tag = static_cast<msgpack::Tag>(input[0]);
+                const auto payloadSize = PayloadSizes<T>[tag];
+
+                if (payloadSize == NotLoadable)
+                {
+                    return 0;
+                }
+
+                if constexpr (std::is_integral<T>::value)
+                {
+                    if (payloadSize == 0)
+                    {
+                        return decodeFixIntRun(input, std::min(size, available), data, bytes);
+                    }
+
+                    const size_t stride = 1 + payloadSize;
+                    if (size == 1 || available < 2 * stride || input[stride] != input[0])
+                    {
+                        return decodeMixed(input, available, data, std::min(size, MixedBlockSize), bytes);
+                    }
+                }
+
+                switch (tag)
+                {
+                case msgpack::Int8:
+                    return decodeTaggedRun<int8_t>(input, available, data, size, bytes);
+                case msgpack::Int16:
+                    return decodeTaggedRun<int16_t>(input, available, data, size, bytes);
+                case msgpack::Int32:
+                    return decodeTaggedRun<int32_t>(input, available, data, size, bytes);
+                case msgpack::Int64:
+                    return decodeTaggedRun<int64_t>(input, available, data, size, bytes);
+                case msgpack::UInt8:
+                    return decodeTaggedRun<uint8_t>(input, available, data, size, bytes);
+                case msgpack::UInt16:
+                    return decodeTaggedRun<uint16_t>(input, available, data, size, bytes);
+                case msgpack::UInt32:
+                    return decodeTaggedRun<uint32_t>(input, available, data, size, bytes);
+                case msgpack::UInt64:
+                    return decodeTaggedRun<uint64_t>(input, available, data, size, bytes);
+                case msgpack::Float:
+                    return decodeTaggedRun<float>(input, available, data, size, bytes);
+                case msgpack::Double:
+                    return decodeTaggedRun<double>(input, available, data, size, bytes);
+                }
+
+                return 0;
+            }
+
+            template <class T>
+            static size_t decodeFixIntRun(const char* input, size_t size, T* data, size_t& bytes) noexcept
+            {
+                using FixInt = std::conditional_t<std::is_signed<T>::value, int8_t, uint8_t>;
+
+                // a whole block is converted before it is checked, so the loop
+                // has no early exits and the compiler vectorizes it
+                size_t count = 0;
+                for (; count + FixIntBlockSize <= size; count += FixIntBlockSize)
+                {
+                    unsigned invalid = 0;
+                    for (size_t i = 0; i < FixIntBlockSize; ++i)
+                    {
+                        const auto tag = static_cast<msgpack::Tag>(input[count + i]);
+                        invalid |= static_cast<unsigned>(!isFixInt<T>(tag));
+                        data[count + i] = static_cast<FixInt>(tag);
+                    }
+
+                    if (invalid != 0)
+                    {
+                        break;
+                    }
+                }
+
+                for (; count < size && isFixInt<T>(static_cast<msgpack::Tag>(input[count])); ++count)
+                {
+                    data[count] = static_cast<FixInt>(input[count]);
+                }
+
+                bytes = count;
+                return count;
+            }
+
+            template <class FromT, class T>
+            static size_t decodeTaggedRun(const char* input, size_t available, T* data, size_t size, size_t& bytes) noexcept
+            {
+                if constexpr (isLoadable<T, FromT>())
+                {
+                    constexpr size_t stride = 1 + sizeof(FromT);
+
+                    const auto n = std::min(size, available / stride);
+
+                    size_t count = 0;
+                    while (count < n && input[count * stride] == input[0])
+                    {
+                        ++count;
+                    }
+
+                    using Bytes = std::conditional_t<sizeof(FromT) == 1, uint8_t,
+                        std::conditional_t<sizeof(FromT) == 2, uint16_t,
+                        std::conditional_t<sizeof(FromT) == 4, uint32_t, uint64_t>>>;
+
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        Bytes bits;
+                        memcpy(&bits, input + i * stride + 1, sizeof(bits));
+                        bits = fromBigEndian(bits);
+
+                        FromT value;
+                        memcpy(&value, &bits, sizeof(value));
+                        data[i] = value;
+                    }
+
+                    bytes = count * stride;
+                    return count;
+                }
+                else
+                {
+                    return 0;
+                }
+            }
+
+            // decodes the integers without branches on their tags: the payload is always
+            // read as 8 bytes and shifted to its actual size, so every item needs 8 bytes
+            // of the input after its tag
+            template <class T>
+            static size_t decodeMixed(const char* input, size_t available, T* data, size_t size, size_t& bytes) noexcept
+            {
+                using Wide = std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>;
+                using FixInt = std::conditional_t<std::is_signed<T>::value, int8_t, uint8_t>;
+
+                size_t pos = 0;
+                size_t count = 0;
+                for (; count < size && pos + 1 + sizeof(uint64_t) <= available; ++count)
+                {
+                    const auto tag = static_cast<msgpack::Tag>(input[pos]);
+                    const auto payloadSize = PayloadSizes<T>[tag];
+                    if (payloadSize == NotLoadable)
+                    {
+                        break;
+                    }
+
+                    uint64_t bits;
+                    memcpy(&bits, input + pos + 1, sizeof(bits));
+                    bits = fromBigEndian(bits);
+
+                    const auto shift = (64 - 8 * payloadSize) & 63;
+                    const auto payload = static_cast<Wide>(bits) >> shift;
+                    const Wide fixInt = static_cast<FixInt>(tag);
+
+                    data[count] = static_cast<T>(payloadSize == 0 ? fixInt : payload);
+                    pos += 1 + payloadSize;
+                }
+
+                bytes = pos;
+                return count;
+            }
+
+            template <class T>
+            static constexpr bool isFixInt(msgpack::Tag tag) noexcept
+            {
+                return std::is_signed<T>::value
+                    ? static_cast<int8_t>(tag) >= msgpack::Min5
+                    : tag <= msgpack::Max7U;
+            }
+
+            // load() accepts the same encodings
+            template <class T, class FromT>
+            static constexpr bool isLoadable() noexcept
+            {
+                if constexpr (std::is_floating_point<T>::value || std::is_floating_point<FromT>::value)
+                {
+                    return std::is_same<T, FromT>::value;
+                }
+                else
+                {
+                    return std::is_signed<T>::value == std::is_signed<FromT>::value && sizeof(FromT) <= sizeof(T);
+                }
+            }
+
+            template <class T, class FromT>
+            static constexpr void setPayloadSize(std::array<uint8_t, 256>& sizes, msgpack::Tag tag) noexcept
+            {
+                if constexpr (isLoadable<T, FromT>())
+                {
+                    sizes[tag] = sizeof(FromT);
+                }
+            }
+
+            template <class T>
+            static constexpr std::array<uint8_t, 256> makePayloadSizes() noexcept
+            {
+                std::array<uint8_t, 256> sizes {};
+                for (size_t i = 0; i < sizes.size(); ++i)
+                {
+                    const auto tag = static_cast<msgpack::Tag>(i);
+                    sizes[i] = std::is_integral<T>::value && isFixInt<T>(tag) ? 0 : NotLoadable;
+                }
+
+                setPayloadSize<T, int8_t>(sizes, msgpack::Int8);
+                setPayloadSize<T, int16_t>(sizes, msgpack::Int16);
+                setPayloadSize<T, int32_t>(sizes, msgpack::Int32);
+                setPayloadSize<T, int64_t>(sizes, msgpack::Int64);
+                setPayloadSize<T, uint8_t>(sizes, msgpack::UInt8);
+                setPayloadSize<T, uint16_t>(sizes, msgpack::UInt16);
+                setPayloadSize<T, uint32_t>(sizes, msgpack::UInt32);
+                setPayloadSize<T, uint64_t>(sizes, msgpack::UInt64);
+                setPayloadSize<T, float>(sizes, msgpack::Float);
+                setPayloadSize<T, double>(sizes, msgpack::Double);
+
+                return sizes;
+            }
+
+            // the payload size of every tag for the items of T, 0 for fixints
+            template <class T>
+            static constexpr std::array<uint8_t, 256> PayloadSizes = makePayloadSizes<T>();
+
             template <class BytesT, class T>
             Error loadFloat(msgpack::Tag expectedTag, T& value)
             {
@@ -362,6 +754,96 @@ namespace pods
                 return Error::CorruptedArchive;
             }
 
+            // the length is either in the tag or in the next lengthSize bytes
+            Error loadLength(msgpack::Tag tag, uint8_t lengthSize, msgpack::Tag mask, Size& size)
+            {
+                switch (lengthSize)
+                {
+                case 0:
+                    size = tag & mask;
+                    return Error::NoError;
+                case 1:
+                {
+                    uint8_t n = 0;
+                    PODS_SAFE_CALL(storage_.get(n));
+                    size = n;
+                    return Error::NoError;
+                }
+                case 2:
+                {
+                    uint16_t n = 0;
+                    PODS_SAFE_CALL(storage_.get(n));
+                    size = n;
+                    return Error::NoError;
+                }
+                }
+
+                return loadSize32(size);
+            }
+
+            Error skipBytes(size_t size)
+            {
+                if constexpr (IsContiguousStorage<Storage>::value)
+                {
+                    const char* data = nullptr;
+                    return storage_.view(data, size);
+                }
+                else
+                {
+                    char buffer[256];
+                    while (size > 0)
+                    {
+                        const auto n = std::min(size, sizeof(buffer));
+                        PODS_SAFE_CALL(storage_.get(buffer, n));
+                        size -= n;
+                    }
+                    return Error::NoError;
+                }
+            }
+
+            // msgpack has no lengths wider than 32 bits regardless of the Size type
+            Error loadSize32(Size& size)
+            {
+                uint32_t n = 0;
+                PODS_SAFE_CALL(storage_.get(n));
+                size = n;
+                return Error::NoError;
+            }
+
+            Error loadStringSize(Size& size)
+            {
+                msgpack::Tag tag;
+                PODS_SAFE_CALL(storage_.get(tag));
+
+                switch (tag)
+                {
+                case msgpack::Str8:
+                {
+                    uint8_t n = 0;
+                    PODS_SAFE_CALL(storage_.get(n));
+                    size = n;
+                    return Error::NoError;
+                }
+                case msgpack::Str16:
+                {
+                    uint16_t n = 0;
+                    PODS_SAFE_CALL(storage_.get(n));
+                    size = n;
+                    return Error::NoError;
+                }
+                case msgpack::Str32:
+                    return loadSize32(size);
+                }
+
+                if ((tag & ~msgpack::StrValue) == msgpack::StrMask)
+                {
+                    size = (tag & msgpack::StrValue);
+                    return Error::NoError;
+                }
+
+                return Error::CorruptedArchive;
+            }
+
             Error loadBinarySize(Size& size)
             {
                 msgpack::Tag tag;
@@ -384,7 +866,7 @@ namespace pods
                     return Error::NoError;
                 }
                 case msgpack::Bin32:
-                    return storage_.get(size);
+                    return loadSize32(size);
                 }
 
                 return Error::CorruptedArchive;
@@ -393,9 +875,11 @@ namespace pods
             template <class T>
             Error tagToInt8(uint8_t tag, T& value) noexcept
             {
-                if (tag <= msgpack::Max8U && static_cast<int8_t>(tag) >= msgpack::Min8)
+                // positive and negative fixints
+                const auto fixInt = static_cast<int8_t>(tag);
+                if (fixInt >= msgpack::Min5)
                 {
-                    value = static_cast<T>(tag);
+                    value = fixInt;
                     return Error::NoError;
                 }
                 return Error::CorruptedArchive;
@@ -423,6 +907,9 @@ namespace pods
 
         private:
             Storage& storage_;
+
+            // the number of the fields left in every struct being loaded (framed encodings only)
+            std::vector<Size> fields_;
         };
     }
 }
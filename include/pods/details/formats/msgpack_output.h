@@ -1,9 +1,13 @@
 ﻿#pragma once
 
-#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
 
 #include "../endianness.h"
 #include "../serialization_traits.h"
+#include "../simd.h"
 #include "../utils.h"
 
 #include "../../errors.h"
@@ -15,19 +19,26 @@ namespace pods
 {
     namespace details
     {
-        template <class Storage>
+        template <class Storage, class Encoding = msgpack::CompactEncoding>
         class MsgPackOutput final
         {
+            static constexpr size_t ArrayBlockSize = 256;
+
+            static_assert(!(Encoding::FramedObjects && Encoding::KeyedObjects),
+                "A struct is either an array or a map");
+
         public:
             using Traits = MsgPackTraits;
 
+            static constexpr bool KeyedObjects = Encoding::KeyedObjects;
+
             explicit MsgPackOutput(Storage& storage) noexcept
                 : storage_(storage)
             {
             }
 
-            MsgPackOutput(const MsgPackOutput<Storage>&) = delete;
-            MsgPackOutput& operator=(const MsgPackOutput<Storage>&) = delete;
+            MsgPackOutput(const MsgPackOutput&) = delete;
+            MsgPackOutput& operator=(const MsgPackOutput&) = delete;
 
             Error startSerialization() noexcept
             {
@@ -40,11 +51,38 @@ namespace pods
                 return Error::NoError;
             }
 
-            Error saveName(const char*) noexcept
+            // the keyed mode saves the ids of the fields by saveFieldId
+            Error saveName(const char* /*name*/) noexcept
             {
                 return Error::NoError;
             }
 
+            static constexpr msgpack::FieldId fieldId(const char* name) noexcept
+            {
+                return msgpack::fieldId(name);
+            }
+
+            Error saveFieldId(msgpack::FieldId id)
+            {
+                return save(id);
+            }
+
+            Error saveFieldCount(Size count)
+            {
+                if constexpr (Encoding::FramedObjects)
+                {
+                    return startArray(count);
+                }
+                else if constexpr (Encoding::KeyedObjects)
+                {
+                    return startMap(count);
+                }
+                else
+                {
+                    return Error::NoError;
+                }
+            }
+
             Error startObject() noexcept
             {
                 return Error::NoError;
@@ -57,20 +95,24 @@ namespace pods
 
             Error startArray(Size size)
             {
-                if (size <= msgpack::ArrayMax)
+                if constexpr (Encoding::FixedWidth)
+                {
+                    PODS_SAFE_CALL(checkSize32(size));
+                    return put(msgpack::Array32, static_cast<uint32_t>(size));
+                }
+                else if (size <= msgpack::ArrayMax)
                 {
                     const msgpack::Tag tag = static_cast<msgpack::Tag>(size) | msgpack::ArrayMask;
                     return storage_.put(tag);
                 }
                 else if (size <= msgpack::Max16U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Array16));
-                    return storage_.put(static_cast<uint16_t>(size));
+                    return put(msgpack::Array16, static_cast<uint16_t>(size));
                 }
                 else
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Array32));
-                    return storage_.put(static_cast<uint32_t>(size));
+                    PODS_SAFE_CALL(checkSize32(size));
+                    return put(msgpack::Array32, static_cast<uint32_t>(size));
                 }
             }
 
@@ -81,20 +123,24 @@ namespace pods
 
             Error startMap(Size size)
             {
-                if (size <= msgpack::MapMax)
+                if constexpr (Encoding::FixedWidth)
+                {
+                    PODS_SAFE_CALL(checkSize32(size));
+                    return put(msgpack::Map32, static_cast<uint32_t>(size));
+                }
+                else if (size <= msgpack::MapMax)
                 {
                     const msgpack::Tag tag = static_cast<msgpack::Tag>(size) | msgpack::MapMask;
                     return storage_.put(tag);
                 }
                 else if (size <= msgpack::Max16U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Map16));
-                    return storage_.put(static_cast<uint16_t>(size));
+                    return put(msgpack::Map16, static_cast<uint16_t>(size));
                 }
                 else
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Map32));
-                    return storage_.put(static_cast<uint32_t>(size));
+                    PODS_SAFE_CALL(checkSize32(size));
+                    return put(msgpack::Map32, static_cast<uint32_t>(size));
                 }
             }
 
@@ -105,78 +151,108 @@ namespace pods
 
             Error save(int8_t value)
             {
-                if (value < msgpack::Min5)
+                if constexpr (Encoding::FixedWidth)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Int8));
+                    return put(msgpack::widestTag<int8_t>(), toBigEndian(value));
                 }
-                return storage_.put(value);
+
+                return value < msgpack::Min5
+                    ? put(msgpack::Int8, value)
+                    : storage_.put(value);
             }
 
             Error save(uint8_t value)
             {
-                if (value > msgpack::Max7U)
+                if constexpr (Encoding::FixedWidth)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::UInt8));
+                    return put(msgpack::widestTag<uint8_t>(), toBigEndian(value));
                 }
-                return storage_.put(value);
+
+                return value > msgpack::Max7U
+                    ? put(msgpack::UInt8, value)
+                    : storage_.put(value);
             }
 
             Error save(int16_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<int16_t>(), toBigEndian(value));
+                }
+
                 if (value < msgpack::Min8 || value > msgpack::Max8)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Int16));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::Int16, toBigEndian(value));
                 }
                 return save(static_cast<int8_t>(value));
             }
 
             Error save(uint16_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<uint16_t>(), toBigEndian(value));
+                }
+
                 if (value > msgpack::Max8U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::UInt16));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::UInt16, toBigEndian(value));
                 }
                 return save(static_cast<uint8_t>(value));
             }
 
             Error save(int32_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<int32_t>(), toBigEndian(value));
+                }
+
                 if (value < msgpack::Min16 || value > msgpack::Max16)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Int32));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::Int32, toBigEndian(value));
                 }
                 return save(static_cast<int16_t>(value));
             }
 
             Error save(uint32_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<uint32_t>(), toBigEndian(value));
+                }
+
                 if (value > msgpack::Max16U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::UInt32));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::UInt32, toBigEndian(value));
                 }
                 return save(static_cast<uint16_t>(value));
             }
 
             Error save(int64_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<int64_t>(), toBigEndian(value));
+                }
+
                 if (value < msgpack::Min32 || value > msgpack::Max32)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Int64));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::Int64, toBigEndian(value));
                 }
                 return save(static_cast<int32_t>(value));
             }
 
             Error save(uint64_t value)
             {
+                if constexpr (Encoding::FixedWidth)
+                {
+                    return put(msgpack::widestTag<uint64_t>(), toBigEndian(value));
+                }
+
                 if (value > msgpack::Max32U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::UInt64));
-                    return storage_.put(toBigEndian(value));
+                    return put(msgpack::UInt64, toBigEndian(value));
                 }
                 return save(static_cast<uint32_t>(value));
             }
@@ -198,69 +274,258 @@ namespace pods
                     : storage_.put(msgpack::False);
             }
 
-            Error save(const std::string& value)
+            Error save(std::string_view value)
             {
                 const auto size = value.size();
-                if (size <= msgpack::Max8U)
+                if constexpr (Encoding::FixedWidth)
                 {
-                    if (size <= msgpack::StrMax)
-                    {
-                        const msgpack::Tag tag = static_cast<msgpack::Tag>(size) | msgpack::StrMask;
-                        PODS_SAFE_CALL(storage_.put(tag));
-                    }
-                    else
-                    {
-                        PODS_SAFE_CALL(storage_.put(msgpack::Str8));
-                        PODS_SAFE_CALL(storage_.put(static_cast<uint8_t>(size)));
-                    }
+                    PODS_SAFE_CALL(checkSize32(size));
+                    PODS_SAFE_CALL(put(msgpack::Str32, static_cast<uint32_t>(size)));
+                }
+                else if (size <= msgpack::StrMax)
+                {
+                    const msgpack::Tag tag = static_cast<msgpack::Tag>(size) | msgpack::StrMask;
+                    PODS_SAFE_CALL(storage_.put(tag));
+                }
+                else if (size <= msgpack::Max8U)
+                {
+                    PODS_SAFE_CALL(put(msgpack::Str8, static_cast<uint8_t>(size)));
                 }
                 else if (size <= msgpack::Max16U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Str16));
-                    PODS_SAFE_CALL(storage_.put(static_cast<uint16_t>(size)));
+                    PODS_SAFE_CALL(put(msgpack::Str16, static_cast<uint16_t>(size)));
                 }
                 else
                 {
-                    assert(size <= msgpack::Max32U);
-                    PODS_SAFE_CALL(storage_.put(msgpack::Str32));
-                    PODS_SAFE_CALL(storage_.put(static_cast<uint32_t>(size)));
+                    PODS_SAFE_CALL(checkSize32(size));
+                    PODS_SAFE_CALL(put(msgpack::Str32, static_cast<uint32_t>(size)));
                 }
-                return storage_.put(value.c_str(), size);
+                return storage_.put(value.data(), size);
             }
 
             template <class T>
             Error saveBlob(const T* data, Size size)
             {
-                if (size <= msgpack::Max8U)
+                if constexpr (Encoding::FixedWidth)
+                {
+                    PODS_SAFE_CALL(checkSize32(size));
+                    PODS_SAFE_CALL(put(msgpack::Bin32, static_cast<uint32_t>(size)));
+                }
+                else if (size <= msgpack::Max8U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Bin8));
-                    PODS_SAFE_CALL(storage_.put(static_cast<uint8_t>(size)));
+                    PODS_SAFE_CALL(put(msgpack::Bin8, static_cast<uint8_t>(size)));
                 }
                 else if (size <= msgpack::Max16U)
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Bin16));
-                    PODS_SAFE_CALL(storage_.put(static_cast<uint16_t>(size)));
+                    PODS_SAFE_CALL(put(msgpack::Bin16, static_cast<uint16_t>(size)));
                 }
                 else
                 {
-                    PODS_SAFE_CALL(storage_.put(msgpack::Bin32));
-                    PODS_SAFE_CALL(storage_.put(size));
+                    PODS_SAFE_CALL(checkSize32(size));
+                    PODS_SAFE_CALL(put(msgpack::Bin32, static_cast<uint32_t>(size)));
                 }
                 return storage_.put(data, size);
             }
 
+            // encodes a contiguous array of numbers by blocks, the range of a block is found
+            // with SIMD and usually allows to write the whole block with a single encoding,
+            // the output is the same as the output of save() for every element
+            template <class T, typename std::enable_if<msgpack::IsNumber<T>::value, int>::type = 0>
+            Error saveArray(const T* data, Size size)
+            {
+                PODS_SAFE_CALL(startArray(size));
+
+                char block[ArrayBlockSize * (1 + sizeof(T)) + sizeof(uint64_t)];
+
+                for (size_t i = 0; i < size; i += ArrayBlockSize)
+                {
+                    const auto count = std::min<size_t>(ArrayBlockSize, size - i);
+                    const auto blockSize = encodeBlock(data + i, count, block);
+                    PODS_SAFE_CALL(storage_.put(block, blockSize));
+                }
+
+                return endArray();
+            }
+
         private:
+            template <class T>
+            static size_t encodeBlock(const T* data, size_t count, char* out) noexcept
+            {
+                if constexpr (std::is_floating_point<T>::value || Encoding::FixedWidth)
+                {
+                    return encodeWidest(data, count, out);
+                }
+                else
+                {
+                    T min;
+                    T max;
+                    simd::minMax(data, count, min, max);
+
+                    if (isFixInt(min) && isFixInt(max))
+                    {
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            out[i] = static_cast<char>(data[i]);
+                        }
+                        return count;
+                    }
+
+                    if (isWidest(min, max))
+                    {
+                        return encodeWidest(data, count, out);
+                    }
+
+                    return encodeMixed(data, count, out);
+                }
+            }
+
+            template <class T>
+            static bool isFixInt(T value) noexcept
+            {
+                if constexpr (std::is_signed<T>::value)
+                {
+                    return value >= msgpack::Min5 && value <= msgpack::Max8;
+                }
+                else
+                {
+                    return value <= msgpack::Max7U;
+                }
+            }
+
+            // all values of [min, max] take the tag and all bytes of the type
+            template <class T>
+            static bool isWidest(T min, T max) noexcept
+            {
+                if constexpr (sizeof(T) == 1)
+                {
+                    return std::is_signed<T>::value
+                        ? max < msgpack::Min5
+                        : min > msgpack::Max7U;
+                }
+                else
+                {
+                    using Narrower = typename msgpack::Narrower<T>::type;
+                    if constexpr (std::is_signed<T>::value)
+                    {
+                        return min > std::numeric_limits<Narrower>::max()
+                            || max < std::numeric_limits<Narrower>::min();
+                    }
+                    else
+                    {
+                        return min > std::numeric_limits<Narrower>::max();
+                    }
+                }
+            }
+
+            template <class T>
+            static size_t encodeWidest(const T* data, size_t count, char* out) noexcept
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    out = encodeTagged(msgpack::widestTag<T>(), data[i], out);
+                }
+                return count * (1 + sizeof(T));
+            }
+
+            // the same choice of the encoding as in save() without branches: every value
+            // is written as the tag and 8 bytes of the payload, the output advances only
+            // by the bytes the encoding takes, so the block needs 8 spare bytes at the end
+            template <class T>
+            static size_t encodeMixed(const T* data, size_t count, char* out) noexcept
+            {
+                static constexpr msgpack::Tag SignedTags[] = { 0, msgpack::Int8, msgpack::Int16, msgpack::Int32, msgpack::Int64 };
+                static constexpr msgpack::Tag UnsignedTags[] = { 0, msgpack::UInt8, msgpack::UInt16, msgpack::UInt32, msgpack::UInt64 };
+                static constexpr uint8_t Sizes[] = { 0, 1, 2, 4, 8 };
+                static constexpr uint8_t Shifts[] = { 0, 56, 48, 32, 0 };
+
+                auto current = out;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const auto value = data[i];
+
+                    size_t width = 0;
+                    if constexpr (std::is_signed<T>::value)
+                    {
+                        const int64_t v = value;
+                        width = (v < msgpack::Min5 || v > msgpack::Max8)
+                            + (v < msgpack::Min8 || v > msgpack::Max8)
+                            + (v < msgpack::Min16 || v > msgpack::Max16)
+                            + (v < msgpack::Min32 || v > msgpack::Max32);
+                    }
+                    else
+                    {
+                        const uint64_t v = value;
+                        width = (v > msgpack::Max7U)
+                            + (v > msgpack::Max8U)
+                            + (v > msgpack::Max16U)
+                            + (v > msgpack::Max32U);
+                    }
+
+                    const auto tag = std::is_signed<T>::value ? SignedTags[width] : UnsignedTags[width];
+                    const auto bits = static_cast<uint64_t>(value); // sign extended
+
+                    *current = width == 0 ? static_cast<char>(value) : static_cast<char>(tag);
+
+                    const auto payload = toBigEndian(bits << Shifts[width]);
+                    memcpy(current + 1, &payload, sizeof(payload));
+
+                    current += 1 + Sizes[width];
+                }
+                return static_cast<size_t>(current - out);
+            }
+
+            template <class T>
+            static char* encodeTagged(msgpack::Tag tag, T value, char* out) noexcept
+            {
+                using Bytes = std::conditional_t<sizeof(T) == 1, uint8_t,
+                    std::conditional_t<sizeof(T) == 2, uint16_t,
+                    std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+                Bytes bytes;
+                memcpy(&bytes, &value, sizeof(T));
+                bytes = toBigEndian(bytes);
+
+                *out = static_cast<char>(tag);
+                memcpy(out + 1, &bytes, sizeof(T));
+                return out + 1 + sizeof(T);
+            }
+
             template <class BytesT, class T>
             Error saveFloat(msgpack::Tag tag, T& value)
             {
-                PODS_SAFE_CALL(storage_.put(tag));
                 union
                 {
                     T value;
                     BytesT bytes;
                 } converter;
                 converter.value = value;
-                return storage_.put(toBigEndian(converter.bytes));
+                return put(tag, toBigEndian(converter.bytes));
+            }
+
+            // msgpack has no lengths wider than 32 bits regardless of the Size type
+            static Error checkSize32(size_t size) noexcept
+            {
+                return size <= msgpack::Max32U
+                    ? Error::NoError
+                    : Error::InvalidSize;
+            }
+
+            // writes the tag and the payload with a single bounds check when the storage allows it
+            template <class T>
+            Error put(msgpack::Tag tag, T value)
+            {
+                if constexpr (IsReservableStorage<Storage>::value)
+                {
+                    PODS_SAFE_CALL(storage_.reserve(sizeof(tag) + sizeof(T)));
+                    storage_.putUnchecked(tag);
+                    storage_.putUnchecked(value);
+                    return Error::NoError;
+                }
+                else
+                {
+                    PODS_SAFE_CALL(storage_.put(tag));
+                    return storage_.put(value);
+                }
             }
 
         private:
@@ -0,0 +1,262 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "simd.h"
+
+#ifdef PODS_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace pods
+{
+    namespace details
+    {
+        constexpr size_t JsonBlockSize = 64;
+
+        // one bit per char of a block of json
+        struct JsonBlockMasks final
+        {
+            uint64_t structural = 0; // {}[]:,
+            uint64_t whitespace = 0;
+            uint64_t quote = 0;
+            uint64_t backslash = 0;
+            uint64_t control = 0; // less than 0x20, forbidden in a string
+        };
+
+        using ClassifyJsonFunction = void (*)(const char* block, JsonBlockMasks& masks);
+
+        inline void classifyJsonScalar(const char* block, JsonBlockMasks& masks) noexcept
+        {
+            masks = JsonBlockMasks();
+
+            for (size_t i = 0; i < JsonBlockSize; ++i)
+            {
+                const auto bit = uint64_t(1) << i;
+                const auto c = static_cast<unsigned char>(block[i]);
+
+                switch (c)
+                {
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    masks.structural |= bit;
+                    break;
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    masks.whitespace |= bit;
+                    break;
+                case '"':
+                    masks.quote |= bit;
+                    break;
+                case '\\':
+                    masks.backslash |= bit;
+                    break;
+                default:
+                    break;
+                }
+
+                if (c < 0x20)
+                {
+                    masks.control |= bit;
+                }
+            }
+        }
+
+#ifdef PODS_SIMD_DISPATCH
+        // the brackets differ from the braces by the bit 0x20 only,
+        // so both are matched after the bit is set
+
+        __attribute__((target("avx2"))) inline uint64_t matchAvx2(__m256i lo, __m256i hi, char c) noexcept
+        {
+            const auto x = _mm256_set1_epi8(c);
+            const uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, x)));
+            const uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, x)));
+            return l | (h << 32);
+        }
+
+        __attribute__((target("avx2"))) inline uint64_t matchControlAvx2(__m256i lo, __m256i hi) noexcept
+        {
+            const auto x = _mm256_set1_epi8(0x1F);
+            const uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(lo, x), lo)));
+            const uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(hi, x), hi)));
+            return l | (h << 32);
+        }
+
+        __attribute__((target("avx2"))) inline void classifyJsonAvx2(const char* block, JsonBlockMasks& masks) noexcept
+        {
+            const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+            const auto bit5 = _mm256_set1_epi8(0x20);
+            const auto lo5 = _mm256_or_si256(lo, bit5);
+            const auto hi5 = _mm256_or_si256(hi, bit5);
+
+            masks.structural = matchAvx2(lo5, hi5, '{') | matchAvx2(lo5, hi5, '}')
+                | matchAvx2(lo, hi, ':') | matchAvx2(lo, hi, ',');
+            masks.whitespace = matchAvx2(lo, hi, ' ') | matchAvx2(lo, hi, '\t')
+                | matchAvx2(lo, hi, '\n') | matchAvx2(lo, hi, '\r');
+            masks.quote = matchAvx2(lo, hi, '"');
+            masks.backslash = matchAvx2(lo, hi, '\\');
+            masks.control = matchControlAvx2(lo, hi);
+        }
+
+        __attribute__((target("sse4.2"))) inline uint64_t matchSse42(const __m128i (&v)[4], char c) noexcept
+        {
+            const auto x = _mm_set1_epi8(c);
+            uint64_t mask = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                mask |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], x)))) << (i * 16);
+            }
+            return mask;
+        }
+
+        __attribute__((target("sse4.2"))) inline uint64_t matchControlSse42(const __m128i (&v)[4]) noexcept
+        {
+            const auto x = _mm_set1_epi8(0x1F);
+            uint64_t mask = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                mask |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v[i], x), v[i])))) << (i * 16);
+            }
+            return mask;
+        }
+
+        __attribute__((target("sse4.2"))) inline void classifyJsonSse42(const char* block, JsonBlockMasks& masks) noexcept
+        {
+            __m128i v[4];
+            __m128i v5[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+                v5[i] = _mm_or_si128(v[i], _mm_set1_epi8(0x20));
+            }
+
+            masks.structural = matchSse42(v5, '{') | matchSse42(v5, '}')
+                | matchSse42(v, ':') | matchSse42(v, ',');
+            masks.whitespace = matchSse42(v, ' ') | matchSse42(v, '\t')
+                | matchSse42(v, '\n') | matchSse42(v, '\r');
+            masks.quote = matchSse42(v, '"');
+            masks.backslash = matchSse42(v, '\\');
+            masks.control = matchControlSse42(v);
+        }
+
+        inline ClassifyJsonFunction selectClassifyJson() noexcept
+        {
+            __builtin_cpu_init();
+
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return classifyJsonAvx2;
+            }
+
+            if (__builtin_cpu_supports("sse4.2"))
+            {
+                return classifyJsonSse42;
+            }
+
+            return classifyJsonScalar;
+        }
+#endif
+
+        // the offsets of the structural chars of the json: the brackets, the colons, the commas,
+        // the quotes that are not escaped (so the closing quote of a string follows the opening one)
+        // and the first chars of the numbers and the literals,
+        // returns false if a string is not closed or contains a control char
+        inline bool buildJsonIndex(const char* data, size_t size, std::vector<uint32_t>& index,
+            ClassifyJsonFunction classify, bool& hasBackslashes)
+        {
+            index.clear();
+            index.reserve(size / 8);
+
+            hasBackslashes = false;
+
+            uint64_t escapedCarry = 0;
+            uint64_t inStringCarry = 0;
+            uint64_t scalarCarry = 0;
+
+            char tail[JsonBlockSize];
+
+            for (size_t offset = 0; offset < size; offset += JsonBlockSize)
+            {
+                auto block = data + offset;
+                if (size - offset < JsonBlockSize)
+                {
+                    memset(tail, ' ', JsonBlockSize);
+                    memcpy(tail, block, size - offset);
+                    block = tail;
+                }
+
+                JsonBlockMasks masks;
+                classify(block, masks);
+
+                // a backslash escapes the next char unless it is escaped itself
+                auto escaped = escapedCarry;
+                escapedCarry = 0;
+                if (masks.backslash != 0)
+                {
+                    hasBackslashes = true;
+                    for (auto bits = masks.backslash; bits != 0; bits &= bits - 1)
+                    {
+                        const auto bit = bits & (~bits + 1);
+                        if ((escaped & bit) == 0)
+                        {
+                            escapedCarry = bit >> 63;
+                            escaped |= bit << 1;
+                        }
+                    }
+                }
+
+                const auto quotes = masks.quote & ~escaped;
+
+                // the prefix xor of the quotes covers the opening quote and the content of a string
+                auto inString = quotes;
+                inString ^= inString << 1;
+                inString ^= inString << 2;
+                inString ^= inString << 4;
+                inString ^= inString << 8;
+                inString ^= inString << 16;
+                inString ^= inString << 32;
+                inString ^= inStringCarry;
+                inStringCarry = 0 - (inString >> 63);
+
+                if ((masks.control & inString) != 0)
+                {
+                    return false;
+                }
+
+                const auto scalars = ~(masks.structural | masks.whitespace | quotes | inString);
+                const auto scalarStarts = scalars & ~((scalars << 1) | scalarCarry);
+                scalarCarry = scalars >> 63;
+
+                for (auto bits = (masks.structural & ~inString) | quotes | scalarStarts; bits != 0; bits &= bits - 1)
+                {
+                    index.push_back(static_cast<uint32_t>(offset + std::countr_zero(bits)));
+                }
+            }
+
+            return inStringCarry == 0;
+        }
+
+        // uses the widest instruction set the processor supports
+        inline bool buildJsonIndex(const char* data, size_t size, std::vector<uint32_t>& index, bool& hasBackslashes)
+        {
+#ifdef PODS_SIMD_DISPATCH
+            static const ClassifyJsonFunction classify = selectClassifyJson();
+#else
+            const ClassifyJsonFunction classify = classifyJsonScalar;
+#endif
+            return buildJsonIndex(data, size, index, classify, hasBackslashes);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+
+namespace pods
+{
+    namespace details
+    {
+        // the buffers use malloc/realloc/free when no memory resource is given,
+        // realloc is able to grow the block in place
+
+        inline char* allocate(std::pmr::memory_resource* resource, size_t size) noexcept
+        {
+            if (resource == nullptr)
+            {
+                return static_cast<char*>(malloc(size));
+            }
+
+            try
+            {
+                return static_cast<char*>(resource->allocate(size, alignof(std::max_align_t)));
+            }
+            catch (const std::bad_alloc&)
+            {
+                return nullptr;
+            }
+        }
+
+        inline void deallocate(std::pmr::memory_resource* resource, char* data, size_t size) noexcept
+        {
+            if (resource == nullptr)
+            {
+                free(data);
+            }
+            else if (data != nullptr)
+            {
+                resource->deallocate(data, size, alignof(std::max_align_t));
+            }
+        }
+
+        // keeps the first used bytes, returns nullptr and leaves data untouched on failure
+        inline char* reallocate(std::pmr::memory_resource* resource,
+            char* data, size_t size, size_t used, size_t newSize) noexcept
+        {
+            if (resource == nullptr)
+            {
+                return static_cast<char*>(realloc(data, newSize));
+            }
+
+            auto newData = allocate(resource, newSize);
+            if (newData != nullptr)
+            {
+                if (used > 0)
+                {
+                    memcpy(newData, data, used);
+                }
+                deallocate(resource, data, size);
+            }
+            return newData;
+        }
+    }
+}
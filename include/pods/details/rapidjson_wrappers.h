@@ -1,5 +1,14 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "settings.h"
+#include "utils.h"
+
 #include "../errors.h"
 
 namespace pods
@@ -42,6 +51,134 @@ namespace pods
             bool good_;
         };
 
+        // writes through a pointer to the free memory of a contiguous storage,
+        // the memory is reserved by chunks, so the bounds are checked once per chunk
+        // and once per string (rapidjson reserves the longest escaped form of it)
+        template <class Storage>
+        struct OutputRapidJsonBulkStream
+        {
+            typedef char Ch;
+
+            static constexpr size_t ChunkSize = PrefferedBufferSize;
+
+            OutputRapidJsonBulkStream(Storage& storage) noexcept
+                : storage_(storage)
+            {
+            }
+
+            OutputRapidJsonBulkStream(const OutputRapidJsonBulkStream&) = delete;
+            OutputRapidJsonBulkStream& operator=(const OutputRapidJsonBulkStream&) = delete;
+
+            void Put(Ch c)
+            {
+                if (current_ == end_)
+                {
+                    reserve(1);
+                }
+
+                *current_++ = c;
+            }
+
+            void PutUnsafe(Ch c) noexcept
+            {
+                assert(current_ < end_);
+                *current_++ = c;
+            }
+
+            void PutReserve(size_t size)
+            {
+                if (static_cast<size_t>(end_ - current_) < size)
+                {
+                    reserve(size);
+                }
+            }
+
+            // the storage may be written by others after the flush,
+            // so the memory is reserved again
+            void Flush()
+            {
+                commit();
+                current_ = nullptr;
+                end_ = nullptr;
+                storage_.flush();
+            }
+
+            bool good() const noexcept
+            {
+                return good_;
+            }
+
+        private:
+            void commit()
+            {
+                if (spilling_)
+                {
+                    const auto size = static_cast<size_t>(current_ - spill_.data());
+                    if (good_ && storage_.put(spill_.data(), size) != Error::NoError)
+                    {
+                        good_ = false;
+                    }
+
+                    spilling_ = false;
+                }
+                else if (good_ && current_ != nullptr)
+                {
+                    storage_.commit(current_);
+                }
+            }
+
+            void reserve(size_t size)
+            {
+                commit();
+
+                if (good_
+                    && (storage_.reserve(std::max(size, ChunkSize), current_, end_) == Error::NoError
+                        || storage_.reserve(size, current_, end_) == Error::NoError))
+                {
+                    return;
+                }
+
+                // rapidjson reserves more than a string usually takes, so the output goes
+                // to the spill buffer and is put to the storage when the next memory is needed,
+                // after an error the output is discarded
+                if (spill_.size() < size)
+                {
+                    spill_.resize(std::max(size, ChunkSize));
+                }
+
+                current_ = spill_.data();
+                end_ = current_ + spill_.size();
+                spilling_ = true;
+            }
+
+        private:
+            Storage& storage_;
+            bool good_ = true;
+            char* current_ = nullptr;
+            char* end_ = nullptr;
+            std::string spill_;
+            bool spilling_ = false;
+        };
+
+        // rapidjson::Writer finds them by argument dependent lookup
+
+        template <class Storage>
+        void PutReserve(OutputRapidJsonBulkStream<Storage>& stream, size_t size)
+        {
+            stream.PutReserve(size);
+        }
+
+        template <class Storage>
+        void PutUnsafe(OutputRapidJsonBulkStream<Storage>& stream, char c) noexcept
+        {
+            stream.PutUnsafe(c);
+        }
+
+        template <class Storage>
+        using OutputRapidJsonStream = std::conditional_t<IsContiguousOutputStorage<Storage>::value,
+            OutputRapidJsonBulkStream<Storage>,
+            OutputRapidJsonStreamWrapper<Storage>>;
+
         template <class Storage>
         struct InputRapidJsonStreamWrapper
         {
@@ -52,6 +189,7 @@ namespace pods
                 , good_(true)
                 , n_(0)
                 , peeked_('\0')
+                , hasPeeked_(false)
             {
             }
 
@@ -59,13 +197,15 @@ namespace pods
             {
                 if (good_)
                 {
-                    if (peeked_ != '\0')
+                    // the peeked char may be \0, so it has a separate flag
+                    if (hasPeeked_)
                     {
                         return peeked_;
                     }
 
                     if (storage_.get(peeked_) == Error::NoError)
                     {
+                        hasPeeked_ = true;
                         return peeked_;
                     }
                 }
@@ -80,9 +220,12 @@ namespace pods
             {
                 if (good_)
                 {
-                    const auto c = peeked_;
-                    peeked_ = '\0';
-                    ++n_;
+                    const auto c = Peek();
+                    hasPeeked_ = false;
+                    if (good_)
+                    {
+                        ++n_;
+                    }
                     return c;
                 }
 
@@ -121,6 +264,118 @@ namespace pods
             mutable bool good_;
             size_t n_;
             mutable char peeked_;
+            mutable bool hasPeeked_;
+        };
+
+        // reads the unread bytes of a contiguous storage (InputBuffer) by pointer
+        // like rapidjson::MemoryStream, the storage is advanced on commit()
+        template <class Storage, class Pointer = const char*>
+        struct InputRapidJsonMemoryStream
+        {
+            typedef char Ch;
+
+            InputRapidJsonMemoryStream(Storage& storage) noexcept
+                : storage_(storage)
+            {
+                // a view of no bytes is always there
+                [[maybe_unused]] const auto error = storage_.view(begin_, 0);
+                assert(error == Error::NoError);
+
+                current_ = begin_;
+                committed_ = begin_;
+                end_ = begin_ + storage_.available();
+            }
+
+            Ch Peek() const noexcept
+            {
+                return current_ != end_
+                    ? *current_
+                    : '\0';
+            }
+
+            Ch Take() noexcept
+            {
+                return current_ != end_
+                    ? *current_++
+                    : '\0';
+            }
+
+            size_t Tell() const noexcept
+            {
+                return static_cast<size_t>(current_ - begin_);
+            }
+
+            void Put(Ch) noexcept
+            {
+                assert(false);
+            }
+
+            Ch* PutBegin() noexcept
+            {
+                assert(false);
+                return nullptr;
+            }
+
+            size_t PutEnd(Ch*) noexcept
+            {
+                assert(false);
+                return '\0';
+            }
+
+            // moves the position of the storage to the first byte that is not parsed
+            void commit() noexcept
+            {
+                // the parsed bytes are never past the end of the storage
+                const char* parsed = nullptr;
+                [[maybe_unused]] const auto error = storage_.view(parsed, static_cast<size_t>(current_ - committed_));
+                assert(error == Error::NoError);
+
+                committed_ = current_;
+            }
+
+        protected:
+            Storage& storage_;
+            Pointer begin_ = nullptr;
+            Pointer current_ = nullptr;
+            Pointer committed_ = nullptr;
+            Pointer end_ = nullptr;
+        };
+
+        // the same as InputRapidJsonMemoryStream, but the reader writes
+        // the unescaped strings over the parsed bytes (rapidjson::kParseInsituFlag)
+        template <class Storage>
+        struct InputRapidJsonInsituStream
+            : InputRapidJsonMemoryStream<Storage, char*>
+        {
+            using InputRapidJsonMemoryStream<Storage, char*>::InputRapidJsonMemoryStream;
+
+            using typename InputRapidJsonMemoryStream<Storage, char*>::Ch;
+
+            // the output never overtakes the input, an escape sequence is longer
+            // than the char it stands for, the closing quote leaves room for \0
+            Ch* PutBegin() noexcept
+            {
+                destination_ = this->current_;
+                return destination_;
+            }
+
+            void Put(Ch c) noexcept
+            {
+                assert(destination_ != nullptr && destination_ < this->current_);
+                *destination_++ = c;
+            }
+
+            size_t PutEnd(Ch* begin) noexcept
+            {
+                return static_cast<size_t>(destination_ - begin);
+            }
+
+            void Flush() noexcept
+            {
+            }
+
+        private:
+            char* destination_ = nullptr;
         };
     }
 }
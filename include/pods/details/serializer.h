@@ -1,9 +1,13 @@
 ﻿#pragma once
 
 #include <algorithm>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
+#include <span>
 #include <string>
+#include <string_view>
 
 #include <array>
 #include <vector>
@@ -20,6 +24,7 @@
 #include <queue>
 
 #include "binary_wrappers.h"
+#include "field_table.h"
 #include "serialization_traits.h"
 #include "utils.h"
 
@@ -48,14 +53,23 @@ namespace pods
                 return serialize(std::forward<T>(data));
             }
 
-            Error operator()() noexcept
+            // a value that is not a field of a struct
+            template <class T>
+            Error saveValue(const T& value)
+            {
+                return processValue(value);
+            }
+
+            Error operator()()
             {
-                return Error::NoError;
+                return format_.saveFieldCount(0);
             }
 
             template <class... ArgsT>
             Error operator()(ArgsT&&... args)
             {
+                // every field is a pair of the name and the value
+                PODS_SAFE_CALL(format_.saveFieldCount(static_cast<Size>(sizeof...(ArgsT) / 2)));
                 return processField(std::forward<ArgsT>(args)...);
             }
 
@@ -69,10 +83,66 @@ namespace pods
                     "You must define the serialize() method for each serializable struct");
 
                 PODS_SAFE_CALL(format_.startSerialization());
-                PODS_SAFE_CALL(const_cast<T&>(value).serialize(*this));
+                if constexpr (IsKeyedFormat<Format>::value)
+                {
+                    FieldsOf<T> fields { *this };
+                    PODS_SAFE_CALL(const_cast<T&>(value).serialize(fields));
+                }
+                else
+                {
+                    PODS_SAFE_CALL(const_cast<T&>(value).serialize(*this));
+                }
                 return format_.endSerialization();
             }
 
+            // passes the type of the struct to processKeyedFields
+            template <class Struct>
+            struct FieldsOf final
+            {
+                Error operator()()
+                {
+                    return serializer_();
+                }
+
+                template <class... ArgsT>
+                Error operator()(ArgsT&&... args)
+                {
+                    auto fields = std::tie(args...);
+                    return serializer_.template processKeyedFields<Struct>(fields, std::make_index_sequence<sizeof...(ArgsT) / 2>());
+                }
+
+                Serializer& serializer_;
+            };
+
+            template <class Struct, class Fields, size_t... I>
+            Error processKeyedFields(Fields& fields, std::index_sequence<I...>)
+            {
+                using FieldId = decltype(Format::fieldId(""));
+
+                // the names of a struct are the same string literals on every call
+                static const std::array<FieldId, sizeof...(I)> ids = { Format::fieldId(std::get<I * 2>(fields))... };
+                static const bool collides = hasCollisions(ids);
+
+                if (collides)
+                {
+                    // an archive with the same key twice cannot be loaded, rename one of the fields
+                    return Error::FieldIdCollision;
+                }
+
+                PODS_SAFE_CALL(format_.saveFieldCount(static_cast<Size>(sizeof...(I))));
+
+                auto error = Error::NoError;
+                (((error = processKeyedField(ids[I], std::get<I * 2 + 1>(fields))) == Error::NoError) && ...);
+                return error;
+            }
+
+            template <class FieldId, class T>
+            Error processKeyedField(FieldId id, const T& value)
+            {
+                PODS_SAFE_CALL(format_.saveFieldId(id));
+                return processValue(value);
+            }
+
             template <class T, typename std::enable_if<std::is_class<T>::value, int>::type = 0>
             Error processField(const char* name, const T& value)
             {
@@ -154,6 +224,22 @@ namespace pods
                 return format_.save(value);
             }
 
+            Error processValue(std::string_view value)
+            {
+                PODS_SAFE_CALL(checkSize(value.size()));
+                return format_.save(value);
+            }
+
+            template <class T>
+            Error processValue(std::span<const T> value)
+            {
+                static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+                const auto size = value.size_bytes();
+                PODS_SAFE_CALL(checkSize(size));
+                return format_.saveBlob(reinterpret_cast<const char*>(value.data()), static_cast<Size>(size));
+            }
+
             Error processValue(const BinaryArray& value)
             {
                 const auto size = value.size();
@@ -243,6 +329,16 @@ namespace pods
             Error saveArray(Iterator begin, size_t size)
             {
                 PODS_SAFE_CALL(checkSize(size));
+
+                if constexpr (std::is_pointer<Iterator>::value)
+                {
+                    using T = std::remove_cv_t<std::remove_pointer_t<Iterator>>;
+                    if constexpr (HasArraySave<Format, T>::value)
+                    {
+                        return format_.saveArray(begin, static_cast<Size>(size));
+                    }
+                }
+
                 PODS_SAFE_CALL(format_.startArray(static_cast<Size>(size)));
 
                 for (size_t i = 0; i < size; ++i)
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(PODS_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PODS_SIMD_DISPATCH
+#endif
+
+namespace pods
+{
+    namespace details
+    {
+        namespace simd
+        {
+            template <class T>
+            using MinMaxFunction = void (*)(const T* data, size_t size, T& min, T& max);
+
+            template <class T>
+            void minMaxScalar(const T* data, size_t size, T& min, T& max) noexcept
+            {
+                assert(size > 0);
+
+                auto lo = data[0];
+                auto hi = data[0];
+                for (size_t i = 1; i < size; ++i)
+                {
+                    lo = data[i] < lo ? data[i] : lo;
+                    hi = data[i] > hi ? data[i] : hi;
+                }
+
+                min = lo;
+                max = hi;
+            }
+
+#ifdef PODS_SIMD_DISPATCH
+            // the compiler lowers the operations on the vectors to the instruction set
+            // of the enclosing function, so the same code serves SSE4.2 and AVX2
+            template <class T, size_t Bytes>
+            inline __attribute__((always_inline)) void minMaxVector(const T* data, size_t size, T& min, T& max) noexcept
+            {
+                typedef T V __attribute__((vector_size(Bytes)));
+                constexpr size_t Lanes = Bytes / sizeof(T);
+
+                if (size < Lanes)
+                {
+                    minMaxScalar(data, size, min, max);
+                    return;
+                }
+
+                V lo;
+                __builtin_memcpy(&lo, data, Bytes);
+                V hi = lo;
+
+                size_t i = Lanes;
+                for (; i + Lanes <= size; i += Lanes)
+                {
+                    V v;
+                    __builtin_memcpy(&v, data + i, Bytes);
+                    lo = v < lo ? v : lo;
+                    hi = v > hi ? v : hi;
+                }
+
+                T lanes[Lanes];
+                T unused;
+
+                __builtin_memcpy(lanes, &lo, Bytes);
+                minMaxScalar(lanes, Lanes, min, unused);
+
+                __builtin_memcpy(lanes, &hi, Bytes);
+                minMaxScalar(lanes, Lanes, unused, max);
+
+                for (; i < size; ++i)
+                {
+                    min = data[i] < min ? data[i] : min;
+                    max = data[i] > max ? data[i] : max;
+                }
+            }
+
+            template <class T>
+            __attribute__((target("avx2"))) void minMaxAvx2(const T* data, size_t size, T& min, T& max)
+            {
+                minMaxVector<T, 32>(data, size, min, max);
+            }
+
+            template <class T>
+            __attribute__((target("sse4.2"))) void minMaxSse42(const T* data, size_t size, T& min, T& max)
+            {
+                minMaxVector<T, 16>(data, size, min, max);
+            }
+
+            template <class T>
+            MinMaxFunction<T> selectMinMax() noexcept
+            {
+                __builtin_cpu_init();
+
+                if (__builtin_cpu_supports("avx2"))
+                {
+                    return minMaxAvx2<T>;
+                }
+
+                if (__builtin_cpu_supports("sse4.2"))
+                {
+                    return minMaxSse42<T>;
+                }
+
+                return minMaxScalar<T>;
+            }
+#endif
+
+            // finds the smallest and the largest of size (> 0) values with the widest
+            // instruction set the processor supports
+            template <class T>
+            void minMax(const T* data, size_t size, T& min, T& max) noexcept
+            {
+#ifdef PODS_SIMD_DISPATCH
+                static const MinMaxFunction<T> function = selectMinMax<T>();
+                function(data, size, min, max);
+#else
+                minMaxScalar(data, size, min, max);
+#endif
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <type_traits>
+#include <utility>
 
 #include "../errors.h"
 #include "../types.h"
@@ -21,6 +22,98 @@ namespace pods
         {
         };
 
+        // serialize() declared by PODS_SERIALIZABLE returns what the serializer returns,
+        // so the number of the fields of a struct is known at compile time
+        struct FieldCounter
+        {
+            std::integral_constant<size_t, 0> operator()() const noexcept
+            {
+                return {};
+            }
+
+            template <class... ArgsT>
+            std::integral_constant<size_t, sizeof...(ArgsT) / 2> operator()(ArgsT&&...) const noexcept
+            {
+                return {};
+            }
+        };
+
+        template <class T>
+        constexpr size_t fieldCount = decltype(std::declval<T&>().serialize(std::declval<FieldCounter&>()))::value;
+
+        template<class S, class = void>
+        struct IsContiguousStorage
+            : std::false_type
+        {
+        };
+
+        template<class S>
+        struct IsContiguousStorage<S, std::void_t<decltype(std::declval<S&>().view(std::declval<const char*&>(), size_t()))>>
+            : std::true_type
+        {
+        };
+
+        template<class S, class = void>
+        struct IsReservableStorage
+            : std::false_type
+        {
+        };
+
+        template<class S>
+        struct IsReservableStorage<S, std::void_t<decltype(std::declval<S&>().reserve(size_t()))>>
+            : std::true_type
+        {
+        };
+
+        // the output storage gives a pointer to its free memory
+        template<class S, class = void>
+        struct IsContiguousOutputStorage
+            : std::false_type
+        {
+        };
+
+        template<class S>
+        struct IsContiguousOutputStorage<S, std::void_t<decltype(std::declval<S&>().commit(std::declval<char*>()))>>
+            : std::true_type
+        {
+        };
+
+        template<class F, class T, class = void>
+        struct HasArraySave
+            : std::false_type
+        {
+        };
+
+        template<class F, class T>
+        struct HasArraySave<F, T, std::void_t<decltype(std::declval<F&>().saveArray(std::declval<const T*>(), Size()))>>
+            : std::true_type
+        {
+        };
+
+        template<class F, class T, class = void>
+        struct HasArrayLoad
+            : std::false_type
+        {
+        };
+
+        template<class F, class T>
+        struct HasArrayLoad<F, T, std::void_t<decltype(std::declval<F&>().loadArrayItems(std::declval<T*>(), Size()))>>
+            : std::true_type
+        {
+        };
+
+        template<class F, class = void>
+        struct IsKeyedFormat
+            : std::false_type
+        {
+        };
+
+        template<class F>
+        struct IsKeyedFormat<F, std::enable_if_t<F::KeyedObjects>>
+            : std::true_type
+        {
+        };
+
         constexpr bool isOptional(const char* name) noexcept
         {
             return *name == 0;
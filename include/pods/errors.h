@@ -19,6 +19,8 @@ namespace pods
         Eof,
         EndOfArray,
         EndOfObject,
+        UnalignedData,
+        FieldIdCollision,
 
         UnknownError
     };
@@ -3,17 +3,28 @@
 #include "details/serializer.h"
 #include "details/deserializer.h"
 
+#include "details/formats/json_indexed_input.h"
 #include "details/formats/json_input.h"
 #include "details/formats/json_output.h"
 
 namespace pods
 {
     template <class Storage>
-    using JsonSerializer = details::Serializer<details::JsonOutput<Storage, rapidjson::Writer<details::OutputRapidJsonStreamWrapper<Storage>>>, Storage>;
+    using JsonSerializer = details::Serializer<details::JsonOutput<Storage, rapidjson::Writer<details::OutputRapidJsonStream<Storage>>>, Storage>;
 
     template <class Storage>
-    using PrettyJsonSerializer = details::Serializer<details::JsonOutput<Storage, rapidjson::PrettyWriter<details::OutputRapidJsonStreamWrapper<Storage>>>, Storage>;
+    using PrettyJsonSerializer = details::Serializer<details::JsonOutput<Storage, rapidjson::PrettyWriter<details::OutputRapidJsonStream<Storage>>>, Storage>;
 
     template <class Storage>
     using JsonDeserializer = details::Deserializer<details::JsonInput<Storage>, Storage>;
+
+    // decodes the strings in place, std::string_view fields point into the buffer,
+    // the storage is InsituInputBuffer
+    template <class Storage>
+    using JsonInsituDeserializer = details::Deserializer<details::JsonInput<Storage, true>, Storage>;
+
+    // builds the structural index of the whole buffer with simd and walks it,
+    // the storage is contiguous (InputBuffer or MappedInputFile)
+    template <class Storage>
+    using JsonIndexedDeserializer = details::Deserializer<details::JsonIndexedInput<Storage>, Storage>;
 }
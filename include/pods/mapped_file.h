@@ -0,0 +1,175 @@
+﻿#pragma once
+
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "buffers.h"
+
+namespace pods
+{
+    namespace details
+    {
+        class FileMapping
+        {
+        protected:
+            explicit FileMapping(const std::string& path)
+                : data_(nullptr)
+                , size_(0)
+            {
+#ifdef _WIN32
+                const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                {
+                    throwLastError(path);
+                }
+
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(file, &size))
+                {
+                    CloseHandle(file);
+                    throwLastError(path);
+                }
+
+                size_ = static_cast<size_t>(size.QuadPart);
+                if (size_ == 0)
+                {
+                    CloseHandle(file);
+                    return;
+                }
+
+                const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                CloseHandle(file);
+                if (mapping == nullptr)
+                {
+                    throwLastError(path);
+                }
+
+                data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+                if (data_ == nullptr)
+                {
+                    throwLastError(path);
+                }
+#else
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd == -1)
+                {
+                    throwLastError(path);
+                }
+
+                struct stat info;
+                if (fstat(fd, &info) == -1)
+                {
+                    const auto error = errno;
+                    close(fd);
+                    throwError(error, path);
+                }
+
+                size_ = static_cast<size_t>(info.st_size);
+                if (size_ == 0)
+                {
+                    close(fd);
+                    return;
+                }
+
+                auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                const auto error = errno;
+                close(fd);
+                if (data == MAP_FAILED)
+                {
+                    throwError(error, path);
+                }
+
+                // the archive is read from the beginning to the end,
+                // so let the kernel read ahead as much as it can
+                madvise(data, size_, MADV_SEQUENTIAL);
+                madvise(data, size_, MADV_WILLNEED);
+
+                data_ = static_cast<const char*>(data);
+#endif
+            }
+
+            ~FileMapping()
+            {
+                if (data_ == nullptr)
+                {
+                    return;
+                }
+#ifdef _WIN32
+                UnmapViewOfFile(data_);
+#else
+                munmap(const_cast<char*>(data_), size_);
+#endif
+            }
+
+            FileMapping(const FileMapping&) = delete;
+            FileMapping& operator=(const FileMapping&) = delete;
+
+            FileMapping(FileMapping&&) = delete;
+            FileMapping& operator=(FileMapping&&) = delete;
+
+        private:
+#ifdef _WIN32
+            [[noreturn]] static void throwLastError(const std::string& path)
+            {
+                throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), path);
+            }
+#else
+            [[noreturn]] static void throwLastError(const std::string& path)
+            {
+                throwError(errno, path);
+            }
+
+            [[noreturn]] static void throwError(int error, const std::string& path)
+            {
+                throw std::system_error(error, std::generic_category(), path);
+            }
+#endif
+
+        protected:
+            const char* data_;
+            size_t size_;
+        };
+    }
+
+    // maps the whole file into memory and reads it as an ordinary InputBuffer,
+    // throws std::system_error if the file can't be mapped
+    class MappedInputFile final
+        : private details::FileMapping
+        , public InputBuffer
+    {
+    public:
+        explicit MappedInputFile(const std::string& path)
+            : details::FileMapping(path)
+            , InputBuffer(FileMapping::data_, FileMapping::size_)
+        {
+        }
+
+        const char* data() const noexcept
+        {
+            return FileMapping::data_;
+        }
+
+        size_t size() const noexcept
+        {
+            return FileMapping::size_;
+        }
+    };
+}
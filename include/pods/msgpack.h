@@ -11,6 +11,28 @@ namespace pods
     template <class Storage>
     using MsgPackSerializer = details::Serializer<details::MsgPackOutput<Storage>, Storage>;
 
+    // writes every number with the full width of its type, any MsgPackDeserializer reads it
+    template <class Storage>
+    using FixedWidthMsgPackSerializer = details::Serializer<details::MsgPackOutput<Storage, details::msgpack::FixedWidthEncoding>, Storage>;
+
     template <class Storage>
     using MsgPackDeserializer = details::Deserializer<details::MsgPackInput<Storage>, Storage>;
+
+    // writes every struct as an array of its fields
+    template <class Storage>
+    using FramedMsgPackSerializer = details::Serializer<details::MsgPackOutput<Storage, details::msgpack::FramedEncoding<>>, Storage>;
+
+    // skips the trailing fields that the struct does not know,
+    // allows the missing trailing fields if they are optional
+    template <class Storage>
+    using FramedMsgPackDeserializer = details::Deserializer<details::MsgPackInput<Storage, details::msgpack::FramedEncoding<>>, Storage>;
+
+    // writes every struct as a map from the hashes of the names of its fields to the values
+    template <class Storage>
+    using KeyedMsgPackSerializer = details::Serializer<details::MsgPackOutput<Storage, details::msgpack::KeyedEncoding<>>, Storage>;
+
+    // accepts the fields in any order, skips the unknown fields,
+    // allows the missing fields if they are optional
+    template <class Storage>
+    using KeyedMsgPackDeserializer = details::Deserializer<details::MsgPackInput<Storage, details::msgpack::KeyedEncoding<>>, Storage>;
 }
@@ -0,0 +1,137 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffers.h"
+#include "errors.h"
+#include "msgpack.h"
+#include "pods.h"
+#include "types.h"
+
+namespace pods
+{
+    // the start offsets of the items of a msgpack array of T, for example
+    // of a std::vector<T> that is the only field of the serialized struct,
+    // the offsets are relative to the beginning of the array, the index itself
+    // is serializable, so it can be stored next to the archive
+    template <class T>
+    class MsgPackArrayIndex final
+    {
+        using Deserializer = MsgPackDeserializer<InputBuffer>;
+
+    public:
+        // scans the array at the beginning of the data once, skipping the items
+        // without decoding them
+        Error build(const char* data, size_t size)
+        {
+            offsets_.clear();
+
+            InputBuffer in(data, size);
+            details::MsgPackInput<InputBuffer> input(in);
+
+            Size count = 0;
+            PODS_SAFE_CALL(input.startArray(count));
+
+            if (count > in.available())
+            {
+                // every item takes at least one byte
+                return Error::CorruptedArchive;
+            }
+
+            offsets_.reserve(static_cast<size_t>(count) + 1);
+
+            Deserializer deserializer(in);
+            T schema {};
+
+            for (Size i = 0; i < count; ++i)
+            {
+                offsets_.push_back(size - in.available());
+                PODS_SAFE_CALL(deserializer.skip(schema));
+            }
+
+            offsets_.push_back(size - in.available());
+            return Error::NoError;
+        }
+
+        // the number of the items
+        size_t size() const noexcept
+        {
+            return offsets_.empty()
+                ? 0
+                : offsets_.size() - 1;
+        }
+
+        // the data is the same the index was built from
+        Error loadElement(const char* data, size_t size, size_t index, T& value) const
+        {
+            PODS_SAFE_CALL(checkRange(size, index, index + 1));
+            return loadItems(data, index, index + 1, &value);
+        }
+
+        // loads the items [first, last)
+        Error loadRange(const char* data, size_t size, size_t first, size_t last, std::vector<T>& values) const
+        {
+            if (first == last && last <= this->size())
+            {
+                values.clear();
+                return Error::NoError;
+            }
+
+            PODS_SAFE_CALL(checkRange(size, first, last));
+
+            values.resize(last - first);
+            return loadItems(data, first, last, values.data());
+        }
+
+        // loads the items [first, last) into values[0, last - first)
+        Error loadRange(const char* data, size_t size, size_t first, size_t last, T* values) const
+        {
+            if (first == last && last <= this->size())
+            {
+                return Error::NoError;
+            }
+
+            PODS_SAFE_CALL(checkRange(size, first, last));
+            return loadItems(data, first, last, values);
+        }
+
+        PODS_SERIALIZABLE(PODS_MDR(offsets_))
+
+    private:
+        Error loadItems(const char* data, size_t first, size_t last, T* values) const
+        {
+            InputBuffer in(data + offsets_[first], offsets_[last] - offsets_[first]);
+            Deserializer deserializer(in);
+
+            for (auto i = first; i < last; ++i)
+            {
+                PODS_SAFE_CALL(deserializer.loadValue(*values++));
+            }
+
+            return in.available() == 0
+                ? Error::NoError
+                : Error::CorruptedArchive;
+        }
+
+        Error checkRange(size_t size, size_t first, size_t last) const noexcept
+        {
+            if (first >= last || last > this->size())
+            {
+                return Error::InvalidSize;
+            }
+
+            // the index may come from another archive
+            if (offsets_[last] > size || offsets_[first] > offsets_[last])
+            {
+                return Error::CorruptedArchive;
+            }
+
+            return Error::NoError;
+        }
+
+    private:
+        // the last offset is the end of the array
+        std::vector<uint64_t> offsets_;
+    };
+}
@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <array>
+#include <cassert>
+
+#include "buffers.h"
+#include "errors.h"
+#include "msgpack.h"
+#include "types.h"
+
+#include "details/utils.h"
+
+namespace pods
+{
+    // read-only access to the fields of T serialized by MsgPackSerializer
+    // without loading the whole struct, a field is decoded on every get(),
+    // the offsets of the fields are remembered, so the bytes before a field
+    // are skipped once, std::string_view and std::span values point into the buffer
+    template <class T>
+    class MsgPackView final
+    {
+        using Deserializer = MsgPackDeserializer<InputBuffer>;
+
+        static constexpr size_t FieldCount = details::fieldCount<T>;
+
+    public:
+        MsgPackView(const char* data, size_t size) noexcept
+            : data_(data)
+            , size_(size)
+        {
+            assert(data != nullptr || size == 0);
+        }
+
+        // takes the unread bytes of the buffer
+        explicit MsgPackView(InputBuffer& buffer) noexcept
+            : size_(buffer.available())
+        {
+            buffer.view(data_, size_);
+        }
+
+        template <class M, class V>
+        Error get(M T::* member, V& value)
+        {
+            const void* const target = &(schema().*member);
+
+            // the start of the current field
+            size_t offset = 0;
+
+            auto field = [&](size_t index, auto& schemaField)
+            {
+                if (index < known_)
+                {
+                    offset = offsets_[index];
+                }
+
+                if (details::getAddress(schemaField) == target)
+                {
+                    InputBuffer in(data_ + offset, size_ - offset);
+                    Deserializer deserializer(in);
+                    PODS_SAFE_CALL(deserializer.loadValue(value));
+                    return Error::EndOfObject;
+                }
+
+                if (index + 1 < known_)
+                {
+                    return Error::NoError;
+                }
+
+                InputBuffer in(data_ + offset, size_ - offset);
+                Deserializer deserializer(in);
+                PODS_SAFE_CALL(deserializer.skip(schemaField));
+
+                offset = size_ - in.available();
+                if (index + 1 == known_ && known_ < FieldCount)
+                {
+                    offsets_[known_++] = offset;
+                }
+
+                return Error::NoError;
+            };
+
+            FieldVisitor<decltype(field)> visitor{ field };
+            const auto error = schema().serialize(visitor);
+
+            if (error == Error::EndOfObject)
+            {
+                return Error::NoError;
+            }
+
+            // the member is not serializable
+            assert(error != Error::NoError);
+            return error == Error::NoError
+                ? Error::MandatoryFieldMissed
+                : error;
+        }
+
+    private:
+        // calls the function for every field, stops on an error
+        template <class F>
+        struct FieldVisitor
+        {
+            Error operator()() noexcept
+            {
+                return Error::NoError;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args)
+            {
+                return visit(0, args...);
+            }
+
+            template <class M, class... ArgsT>
+            Error visit(size_t index, const char*, M& value, ArgsT&... args)
+            {
+                PODS_SAFE_CALL(function_(index, value));
+
+                if constexpr (sizeof...(ArgsT) > 0)
+                {
+                    return visit(index + 1, args...);
+                }
+                else
+                {
+                    return Error::NoError;
+                }
+            }
+
+            F& function_;
+        };
+
+        // the fields of the instance are only compared by address and describe
+        // the types of the fields, it is never modified
+        static T& schema()
+        {
+            static T instance {};
+            return instance;
+        }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+
+        std::array<size_t, FieldCount> offsets_ = {};
+        size_t known_ = 1;
+    };
+}
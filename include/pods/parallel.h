@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buffers.h"
+#include "errors.h"
+#include "msgpack.h"
+#include "msgpack_array_index.h"
+
+namespace pods
+{
+    namespace details
+    {
+        // the number of the chunks per thread, the threads take the chunks one by one,
+        // so a thread that got cheap items takes more chunks
+        static constexpr size_t ChunksPerThread = 16;
+
+        struct Chunks
+        {
+            size_t threads;
+            size_t chunkSize;
+            size_t count;
+        };
+
+        // threads == 0 means one thread per core
+        inline Chunks makeChunks(size_t size, size_t threads)
+        {
+            if (threads == 0)
+            {
+                threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            }
+
+            threads = std::min(threads, size);
+            if (threads <= 1)
+            {
+                return { 1, size, size == 0 ? 0u : 1u };
+            }
+
+            const auto chunkSize = std::max<size_t>(size / (threads * ChunksPerThread), 1);
+            return { threads, chunkSize, (size + chunkSize - 1) / chunkSize };
+        }
+
+        // calls job(chunk, first, last) for the chunks of [0, size) on the threads including
+        // the calling one, returns the first error, rethrows the first exception
+        template <class Job>
+        Error runChunks(size_t size, const Chunks& chunks, const Job& job)
+        {
+            std::atomic<size_t> next = 0;
+            std::atomic<bool> failed = false;
+
+            std::mutex mutex;
+            Error error = Error::NoError;
+            std::exception_ptr exception;
+
+            auto worker = [&]()
+            {
+                try
+                {
+                    while (!failed.load(std::memory_order_relaxed))
+                    {
+                        const auto chunk = next.fetch_add(1, std::memory_order_relaxed);
+                        if (chunk >= chunks.count)
+                        {
+                            return;
+                        }
+
+                        const auto first = chunk * chunks.chunkSize;
+                        const auto result = job(chunk, first, std::min(first + chunks.chunkSize, size));
+                        if (result != Error::NoError)
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (error == Error::NoError)
+                            {
+                                error = result;
+                            }
+                            failed = true;
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!exception)
+                    {
+                        exception = std::current_exception();
+                    }
+                    failed = true;
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(chunks.threads - 1);
+            for (size_t i = 1; i < chunks.threads; ++i)
+            {
+                pool.emplace_back(worker);
+            }
+
+            worker();
+
+            for (auto& thread : pool)
+            {
+                thread.join();
+            }
+
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+
+            return error;
+        }
+    }
+
+    // loads the msgpack array of T at the beginning of the data, for example
+    // a std::vector<T> that is the only field of the serialized struct,
+    // the items are decoded concurrently right into their places in values,
+    // threads == 0 means one thread per core
+    template <class T>
+    Error parallelLoad(const MsgPackArrayIndex<T>& index, const char* data, size_t size,
+        std::vector<T>& values, size_t threads = 0)
+    {
+        values.resize(index.size());
+
+        return details::runChunks(index.size(), details::makeChunks(index.size(), threads),
+            [&](size_t, size_t first, size_t last)
+            {
+                return index.loadRange(data, size, first, last, values.data() + first);
+            });
+    }
+
+    // scans the array to build the index first, the scan only skips the items
+    template <class T>
+    Error parallelLoad(const char* data, size_t size, std::vector<T>& values, size_t threads = 0)
+    {
+        MsgPackArrayIndex<T> index;
+        PODS_SAFE_CALL(index.build(data, size));
+        return parallelLoad(index, data, size, values, threads);
+    }
+
+    // writes the same bytes as MsgPackSerializer writes for a struct whose only
+    // field is values, the chunks of the items are encoded concurrently into
+    // separate buffers and then copied to the storage one by one
+    template <class Storage, class T>
+    Error parallelSave(Storage& storage, const std::vector<T>& values, size_t threads = 0)
+    {
+        PODS_SAFE_CALL(details::checkSize(values.size()));
+
+        const auto chunks = details::makeChunks(values.size(), threads);
+        std::vector<ResizableOutputBuffer> buffers(chunks.count);
+
+        PODS_SAFE_CALL(details::runChunks(values.size(), chunks,
+            [&](size_t chunk, size_t first, size_t last)
+            {
+                auto& buffer = buffers[chunk];
+                MsgPackSerializer<ResizableOutputBuffer> serializer(buffer);
+
+                for (auto i = first; i < last; ++i)
+                {
+                    PODS_SAFE_CALL(serializer.saveValue(values[i]));
+                }
+
+                return Error::NoError;
+            }));
+
+        details::MsgPackOutput<Storage> output(storage);
+        PODS_SAFE_CALL(output.startArray(static_cast<Size>(values.size())));
+
+        for (const auto& buffer : buffers)
+        {
+            PODS_SAFE_CALL(storage.put(buffer.data(), buffer.size()));
+        }
+
+        return output.endSerialization();
+    }
+}
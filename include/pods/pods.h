@@ -40,7 +40,7 @@
 #endif
 #define PODS_SERIALIZABLE(...)                                          \
     template <class Serializer>                                         \
-    pods::Error serialize(Serializer& serializer)                       \
+    auto serialize(Serializer& serializer)                              \
     {                                                                   \
         return serializer(__VA_ARGS__);                                 \
     }                                                                   \
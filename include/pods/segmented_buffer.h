@@ -0,0 +1,327 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+#include "details/settings.h"
+#include "details/utils.h"
+
+#include "errors.h"
+#include "types.h"
+
+namespace pods
+{
+#ifdef _WIN32
+    struct IoVec
+    {
+        void* iov_base;
+        size_t iov_len;
+    };
+#else
+    using IoVec = iovec;
+#endif
+
+    // thread safe cache of equally sized memory blocks
+    class SegmentPool final
+    {
+    public:
+        explicit SegmentPool(size_t segmentSize = details::PrefferedBufferSize) noexcept
+            : segmentSize_(segmentSize)
+        {
+            assert(segmentSize > 0);
+        }
+
+        ~SegmentPool()
+        {
+            for (auto segment : free_)
+            {
+                free(segment);
+            }
+        }
+
+        SegmentPool(const SegmentPool&) = delete;
+        SegmentPool& operator=(const SegmentPool&) = delete;
+
+        SegmentPool(SegmentPool&&) = delete;
+        SegmentPool& operator=(SegmentPool&&) = delete;
+
+        char* acquire() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!free_.empty())
+                {
+                    auto segment = free_.back();
+                    free_.pop_back();
+                    return segment;
+                }
+            }
+
+            return static_cast<char*>(malloc(segmentSize_));
+        }
+
+        void release(char* segment)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(segment);
+        }
+
+        size_t segmentSize() const noexcept
+        {
+            return segmentSize_;
+        }
+
+    private:
+        const size_t segmentSize_;
+
+        std::mutex mutex_;
+        std::vector<char*> free_;
+    };
+
+    // output storage built from a chain of fixed size segments,
+    // the data that is already written is never moved
+    class SegmentedOutputBuffer final
+    {
+    public:
+        explicit SegmentedOutputBuffer(
+            size_t segmentSize = details::PrefferedBufferSize,
+            size_t maxSize = std::numeric_limits<Size>::max()) noexcept
+            : pool_(nullptr)
+            , segmentSize_(segmentSize)
+            , maxSize_(maxSize)
+            , active_(0)
+            , current_(nullptr)
+            , end_(nullptr)
+        {
+            assert(segmentSize > 0);
+        }
+
+        explicit SegmentedOutputBuffer(
+            SegmentPool& pool,
+            size_t maxSize = std::numeric_limits<Size>::max()) noexcept
+            : pool_(&pool)
+            , segmentSize_(pool.segmentSize())
+            , maxSize_(maxSize)
+            , active_(0)
+            , current_(nullptr)
+            , end_(nullptr)
+        {
+        }
+
+        ~SegmentedOutputBuffer()
+        {
+            for (auto segment : segments_)
+            {
+                if (pool_ != nullptr)
+                {
+                    pool_->release(segment);
+                }
+                else
+                {
+                    free(segment);
+                }
+            }
+        }
+
+        SegmentedOutputBuffer(const SegmentedOutputBuffer&) = delete;
+        SegmentedOutputBuffer& operator=(const SegmentedOutputBuffer&) = delete;
+
+        SegmentedOutputBuffer(SegmentedOutputBuffer&&) = delete;
+        SegmentedOutputBuffer& operator=(SegmentedOutputBuffer&&) = delete;
+
+        Error put(bool value)
+        {
+            return put(value ? True : False);
+        }
+
+        template <class T, typename std::enable_if<sizeof(T) == 1, int>::type = 0>
+        Error put(T value)
+        {
+            if (current_ == end_)
+            {
+                PODS_SAFE_CALL(nextSegment());
+            }
+            *current_++ = static_cast<char>(value);
+            return Error::NoError;
+        }
+
+        template <class T, typename std::enable_if<sizeof(T) != 1, int>::type = 0>
+        Error put(T value)
+        {
+            if (current_ + sizeof(T) <= end_)
+            {
+                memcpy(current_, &value, sizeof(T));
+                current_ += sizeof(T);
+                return Error::NoError;
+            }
+            return put(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        Error put(const char* data, size_t size)
+        {
+            if (size > maxSize_ - this->size())
+            {
+                return Error::NotEnoughMemory;
+            }
+
+            while (size > 0)
+            {
+                if (current_ == end_)
+                {
+                    PODS_SAFE_CALL(nextSegment());
+                }
+
+                const auto n = std::min(size, static_cast<size_t>(end_ - current_));
+                memcpy(current_, data, n);
+                current_ += n;
+                data += n;
+                size -= n;
+            }
+
+            return Error::NoError;
+        }
+
+        template <class T>
+        Error put(const T* data, size_t size)
+        {
+            const auto totalSize = size * sizeof(T);
+            return put(reinterpret_cast<const char*>(data), totalSize);
+        }
+
+        size_t size() const noexcept
+        {
+            return current_ == nullptr
+                ? 0
+                : active_ * segmentSize_ + static_cast<size_t>(current_ - segments_[active_]);
+        }
+
+        size_t segmentSize() const noexcept
+        {
+            return segmentSize_;
+        }
+
+        // fills the list that can be passed to writev/sendmsg as is
+        void getIoVecs(std::vector<IoVec>& result) const
+        {
+            result.clear();
+
+            if (current_ == nullptr)
+            {
+                return;
+            }
+
+            result.reserve(active_ + 1);
+
+            for (size_t i = 0; i < active_; ++i)
+            {
+                result.push_back(IoVec{ segments_[i], segmentSize_ });
+            }
+
+            const auto used = static_cast<size_t>(current_ - segments_[active_]);
+            if (used > 0)
+            {
+                result.push_back(IoVec{ segments_[active_], used });
+            }
+        }
+
+        std::vector<IoVec> getIoVecs() const
+        {
+            std::vector<IoVec> result;
+            getIoVecs(result);
+            return result;
+        }
+
+        // copies the content to the contiguous memory of size() bytes
+        void copyTo(char* data) const noexcept
+        {
+            if (current_ == nullptr)
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < active_; ++i)
+            {
+                memcpy(data, segments_[i], segmentSize_);
+                data += segmentSize_;
+            }
+
+            memcpy(data, segments_[active_], static_cast<size_t>(current_ - segments_[active_]));
+        }
+
+        // keeps the allocated segments for reuse
+        void clear() noexcept
+        {
+            active_ = 0;
+            if (segments_.empty())
+            {
+                current_ = nullptr;
+                end_ = nullptr;
+            }
+            else
+            {
+                current_ = segments_[0];
+                end_ = current_ + std::min(segmentSize_, maxSize_);
+            }
+        }
+
+        void flush() noexcept
+        {
+        }
+
+    private:
+        Error nextSegment()
+        {
+            const auto next = current_ == nullptr
+                ? active_
+                : active_ + 1;
+
+            const auto used = next * segmentSize_;
+            if (used >= maxSize_)
+            {
+                return Error::NotEnoughMemory;
+            }
+
+            if (next == segments_.size())
+            {
+                auto segment = pool_ != nullptr
+                    ? pool_->acquire()
+                    : static_cast<char*>(malloc(segmentSize_));
+
+                if (segment == nullptr)
+                {
+                    return Error::NotEnoughMemory;
+                }
+
+                segments_.push_back(segment);
+            }
+
+            active_ = next;
+            current_ = segments_[active_];
+            end_ = current_ + std::min(segmentSize_, maxSize_ - used);
+
+            return Error::NoError;
+        }
+
+    private:
+        SegmentPool* const pool_;
+
+        const size_t segmentSize_;
+        const size_t maxSize_;
+
+        std::vector<char*> segments_;
+        size_t active_;
+
+        char* current_;
+        char* end_;
+    };
+}
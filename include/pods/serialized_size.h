@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "details/utils.h"
+
+#include "errors.h"
+#include "types.h"
+
+namespace pods
+{
+    // output storage that discards the data and only counts bytes
+    class SizeCountingStorage final
+    {
+    public:
+        SizeCountingStorage() noexcept
+            : size_(0)
+        {
+        }
+
+        SizeCountingStorage(const SizeCountingStorage&) = delete;
+        SizeCountingStorage& operator=(const SizeCountingStorage&) = delete;
+
+        SizeCountingStorage(SizeCountingStorage&&) = delete;
+        SizeCountingStorage& operator=(SizeCountingStorage&&) = delete;
+
+        Error put(bool) noexcept
+        {
+            size_ += sizeof(Bool);
+            return Error::NoError;
+        }
+
+        template <class T>
+        Error put(T) noexcept
+        {
+            size_ += sizeof(T);
+            return Error::NoError;
+        }
+
+        template <class T>
+        Error put(const T*, size_t size) noexcept
+        {
+            size_ += size * sizeof(T);
+            return Error::NoError;
+        }
+
+        Error reserve(size_t) noexcept
+        {
+            return Error::NoError;
+        }
+
+        template <class T>
+        void putUnchecked(T) noexcept
+        {
+            size_ += sizeof(T);
+        }
+
+        size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        void clear() noexcept
+        {
+            size_ = 0;
+        }
+
+        void flush() noexcept
+        {
+        }
+
+    private:
+        size_t size_;
+    };
+
+    // calculates the exact size of the archive without writing it,
+    // e.g. pods::serializedSize<pods::MsgPackSerializer>(data, size)
+    template <template <class> class Serializer, class T>
+    Error serializedSize(T&& data, size_t& size)
+    {
+        SizeCountingStorage storage;
+        Serializer<SizeCountingStorage> serializer(storage);
+        PODS_SAFE_CALL(serializer.save(std::forward<T>(data)));
+        size = storage.size();
+        return Error::NoError;
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cassert>
 #include <istream>
 #include <ostream>
 
@@ -15,8 +16,10 @@ namespace pods
     public:
         explicit InputStream(std::istream& stream, size_t bufferSize = details::PrefferedBufferSize)
             : in_(stream)
+            , capacity_(bufferSize)
             , buffer_(bufferSize)
         {
+            assert(bufferSize >= sizeof(uint64_t));
             buffer_.gotoEnd();
         }
 
@@ -29,25 +32,11 @@ namespace pods
         template <class T>
         Error get(T& value) noexcept
         {
-            const size_t available = buffer_.available();
-            if (available >= sizeof(T))
-            {
-                return buffer_.get(value);
-            }
-
-            if (in_.eof())
-            {
-                return Error::UnexpectedEnd;
-            }
-
-            if (available > 0)
+            if (buffer_.available() < sizeof(T))
             {
-                auto pos = in_.tellg();
-                pos -= static_cast<std::streamsize>(available);
-                in_.seekg(pos, std::ios_base::beg);
+                PODS_SAFE_CALL(fill(sizeof(T)));
             }
 
-            PODS_SAFE_CALL(readBuffer());
             return buffer_.get(value);
         }
 
@@ -59,27 +48,14 @@ namespace pods
                 return buffer_.get(data, size);
             }
 
-            if (in_.eof())
-            {
-                return Error::UnexpectedEnd;
-            }
-
-            if (available > 0)
+            if (size <= capacity_)
             {
-                auto pos = in_.tellg();
-                pos -= static_cast<std::streamsize>(available);
-                in_.seekg(pos, std::ios_base::beg);
-            }
-
-            if (size > buffer_.maxSize())
-            {
-                PODS_SAFE_CALL(read(data, size));
-                buffer_.gotoEnd();
-                return Error::NoError;
+                PODS_SAFE_CALL(fill(size));
+                return buffer_.get(data, size);
             }
 
-            PODS_SAFE_CALL(readBuffer());
-            return buffer_.get(data, size);
+            PODS_SAFE_CALL(buffer_.get(data, available));
+            return read(data + available, size - available);
         }
 
         template <class T>
@@ -90,23 +66,57 @@ namespace pods
         }
 
     private:
-        Error readBuffer()
+        // keeps the unread tail of the buffer and tops it up from the stream,
+        // blocks only until the required number of bytes is available
+        Error fill(size_t required)
         {
-            PODS_SAFE_CALL(read(buffer_.data(), buffer_.maxSize()));
-            buffer_.reset(static_cast<size_t>(in_.gcount()));
-            return Error::NoError;
+            auto size = buffer_.compact();
+            auto data = buffer_.data();
+
+            size += readSome(data + size, capacity_ - size);
+            if (size < required)
+            {
+                in_.read(data + size, static_cast<std::streamsize>(required - size));
+                size += static_cast<size_t>(in_.gcount());
+                size += readSome(data + size, capacity_ - size);
+            }
+
+            buffer_.reset(size);
+
+            if (size >= required)
+            {
+                return Error::NoError;
+            }
+
+            return in_.bad()
+                ? Error::ReadError
+                : Error::UnexpectedEnd;
+        }
+
+        // takes only the bytes that the stream already has, never blocks
+        size_t readSome(char* data, size_t size)
+        {
+            return size > 0
+                ? static_cast<size_t>(in_.readsome(data, static_cast<std::streamsize>(size)))
+                : 0;
         }
 
         Error read(char* data, size_t size)
         {
-            const bool success = !!in_.read(data, static_cast<std::streamsize>(size));
-            return success || in_.eof()
-                ? Error::NoError
-                : Error::ReadError;
+            in_.read(data, static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(in_.gcount()) == size)
+            {
+                return Error::NoError;
+            }
+
+            return in_.bad()
+                ? Error::ReadError
+                : Error::UnexpectedEnd;
         }
 
     private:
         std::istream& in_;
+        const size_t capacity_;
         InputBuffer buffer_;
     };
 
@@ -168,6 +178,25 @@ namespace pods
             return put(reinterpret_cast<const char*>(data), totalSize);
         }
 
+        // guarantees that the next size bytes can be written by putUnchecked,
+        // size must not exceed the buffer size
+        Error reserve(size_t size)
+        {
+            if (buffer_.available() >= size)
+            {
+                return Error::NoError;
+            }
+
+            PODS_SAFE_CALL(writeBuffer());
+            return buffer_.reserve(size);
+        }
+
+        template <class T>
+        void putUnchecked(T value) noexcept
+        {
+            buffer_.putUnchecked(value);
+        }
+
         Error flush()
         {
             if (buffer_.size() > 0)
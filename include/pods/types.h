@@ -6,7 +6,12 @@
 namespace pods
 {
     using Bool = uint8_t;
+
+#ifdef PODS_64BIT_SIZE
+    using Size = uint64_t;
+#else
     using Size = uint32_t;
+#endif
 
     static constexpr Bool False = 0;
     static constexpr Bool True = 1;
@@ -209,3 +209,42 @@ TEST(buffer, testCtor)
 
     EXPECT_EQ(expected, actual);
 }
+
+TEST(buffer, testReserve)
+{
+    pods::OutputBuffer out(5);
+    EXPECT_EQ(out.reserve(6), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.reserve(5), pods::Error::NoError);
+
+    out.putUnchecked(static_cast<uint8_t>(1));
+    out.putUnchecked(static_cast<uint32_t>(2));
+    EXPECT_EQ(out.available(), 0);
+    EXPECT_EQ(out.reserve(1), pods::Error::NotEnoughMemory);
+
+    uint8_t a1 = 0;
+    uint32_t a2 = 0;
+    pods::InputBuffer in(out.data(), out.size());
+    EXPECT_EQ(in.get(a1), pods::Error::NoError);
+    EXPECT_EQ(in.get(a2), pods::Error::NoError);
+    EXPECT_EQ(a1, 1);
+    EXPECT_EQ(a2, 2);
+}
+
+TEST(buffer, testMove)
+{
+    pods::OutputBuffer out(sizeof(uint32_t));
+    EXPECT_EQ(out.put(static_cast<uint32_t>(1)), pods::Error::NoError);
+
+    pods::OutputBuffer movedOut(std::move(out));
+    EXPECT_EQ(movedOut.size(), sizeof(uint32_t));
+    EXPECT_EQ(out.size(), 0);
+
+    pods::InputBuffer in(movedOut.data(), movedOut.size());
+    pods::InputBuffer movedIn(nullptr, 0);
+    movedIn = std::move(in);
+
+    uint32_t actual = 0;
+    EXPECT_EQ(in.get(actual), pods::Error::UnexpectedEnd);
+    EXPECT_EQ(movedIn.get(actual), pods::Error::NoError);
+    EXPECT_EQ(actual, 1);
+}
@@ -0,0 +1,58 @@
+﻿#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <pods/buffer_pool.h>
+
+TEST(bufferPool, reuse)
+{
+    pods::BufferPool pool(1, 4);
+
+    auto buffer = pool.acquire();
+    EXPECT_EQ(buffer.capacity(), 4);
+    EXPECT_EQ(buffer.put(static_cast<uint64_t>(1)), pods::Error::NoError);
+    const auto capacity = buffer.capacity();
+    const auto data = buffer.data();
+
+    pool.release(std::move(buffer));
+    EXPECT_EQ(pool.size(), 1);
+
+    auto reused = pool.acquire();
+    EXPECT_EQ(pool.size(), 0);
+    EXPECT_EQ(reused.size(), 0);
+    EXPECT_EQ(reused.capacity(), capacity);
+    EXPECT_EQ(reused.data(), data);
+
+    auto other = pool.acquire();
+    pool.release(std::move(reused));
+    pool.release(std::move(other));
+    EXPECT_EQ(pool.size(), 1);
+}
+
+TEST(bufferPool, threads)
+{
+    pods::BufferPool pool;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&pool]()
+        {
+            for (uint32_t j = 0; j < 1000; ++j)
+            {
+                auto buffer = pool.acquire();
+                EXPECT_EQ(buffer.size(), 0);
+                EXPECT_EQ(buffer.put(j), pods::Error::NoError);
+                pool.release(std::move(buffer));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_LE(pool.size(), 4);
+}
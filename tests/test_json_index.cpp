@@ -0,0 +1,285 @@
+﻿#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/details/json_index.h>
+#include <pods/json.h>
+#include <pods/pods.h>
+
+namespace
+{
+    // char by char, a backslash escapes the next char outside of the strings too
+    std::vector<uint32_t> referenceIndex(const std::string& json)
+    {
+        std::vector<uint32_t> index;
+
+        bool inString = false;
+        bool inScalar = false;
+        bool escaped = false;
+        for (size_t i = 0; i < json.size(); ++i)
+        {
+            const auto c = json[i];
+            const bool isQuote = c == '"' && !escaped;
+            escaped = c == '\\' && !escaped;
+
+            if (inString)
+            {
+                if (isQuote)
+                {
+                    index.push_back(static_cast<uint32_t>(i));
+                    inString = false;
+                }
+                continue;
+            }
+
+            const bool isStructural = c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+            const bool isSpace = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+
+            if (isQuote || isStructural || (!isSpace && !inScalar))
+            {
+                index.push_back(static_cast<uint32_t>(i));
+            }
+
+            inString = isQuote;
+            inScalar = !isStructural && !isSpace && !isQuote;
+        }
+
+        return index;
+    }
+
+    // every instruction set the processor supports
+    std::vector<pods::details::ClassifyJsonFunction> getClassifiers()
+    {
+        std::vector<pods::details::ClassifyJsonFunction> classifiers = { pods::details::classifyJsonScalar };
+#ifdef PODS_SIMD_DISPATCH
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            classifiers.push_back(pods::details::classifyJsonSse42);
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            classifiers.push_back(pods::details::classifyJsonAvx2);
+        }
+#endif
+        return classifiers;
+    }
+
+    void checkIndex(const std::string& json)
+    {
+        const auto expected = referenceIndex(json);
+
+        std::vector<uint32_t> index;
+        bool hasBackslashes = false;
+
+        for (const auto classify : getClassifiers())
+        {
+            EXPECT_TRUE(pods::details::buildJsonIndex(json.data(), json.size(), index, classify, hasBackslashes));
+            EXPECT_EQ(index, expected);
+        }
+    }
+
+    struct Point
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        bool operator==(const Point&) const = default;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y))
+    };
+
+    struct Document
+    {
+        uint64_t id = 0;
+        int8_t small = 0;
+        bool ok = false;
+        double ratio = 0;
+        float scale = 0;
+        std::string name;
+        std::vector<Point> points;
+        std::vector<std::vector<int32_t>> matrix;
+        std::map<std::string, std::string> tags;
+        std::vector<uint32_t> blob;
+
+        bool operator==(const Document&) const = default;
+
+        PODS_SERIALIZABLE(
+            PODS_MDR(id),
+            PODS_MDR(small),
+            PODS_MDR(ok),
+            PODS_MDR(ratio),
+            PODS_MDR(scale),
+            PODS_OPT(name),
+            PODS_MDR(points),
+            PODS_MDR(matrix),
+            PODS_MDR(tags),
+            PODS_MDR_BIN(blob))
+    };
+
+    Document makeDocument()
+    {
+        Document document;
+        document.id = 0xffffffffffffffff;
+        document.small = -128;
+        document.ok = true;
+        document.ratio = -1.25e-7;
+        document.scale = 3.5f;
+        document.name = "quote \" backslash \\ tab \t \xd0\xbc\xd0\xb8\xd1\x80";
+        document.points = { { 1, -2 }, { 3, 4 } };
+        document.matrix = { { 1, 2 }, {}, { 3 } };
+        document.tags = { { "a", "b" }, { "key \n", "" } };
+        document.blob = { 1, 2, 3 };
+        return document;
+    }
+
+    pods::Error load(const std::string& json, Document& document)
+    {
+        pods::InputBuffer in(json.data(), json.size());
+        pods::JsonIndexedDeserializer<decltype(in)> deserializer(in);
+        return deserializer.load(document);
+    }
+}
+
+TEST(jsonIndex, testIndex)
+{
+    checkIndex(R"({"a":[1,2.5,-3e2,true,false,null],"b":{"c\"":"\\","d":"x\\\"y"}})");
+    checkIndex(R"(  { "a" : 1 , "b" : [ "" , "\\\\" ] }  )");
+
+    // the strings, the escapes and the numbers cross the blocks
+    std::mt19937 random(42);
+    const std::string parts[] = { "\"", "\\", "\\\\", "\\\"", "{", "}", "[", "]", ":", ",", " ", "\n", "1", "-2.5", "true", "abc" };
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string json;
+        const auto size = random() % 300;
+        while (json.size() < size)
+        {
+            json += parts[random() % std::size(parts)];
+        }
+
+        const auto expected = referenceIndex(json);
+
+        std::vector<uint32_t> scalarIndex;
+        bool hasBackslashes = false;
+        const bool closed = pods::details::buildJsonIndex(json.data(), json.size(), scalarIndex, pods::details::classifyJsonScalar, hasBackslashes);
+
+        if (closed)
+        {
+            EXPECT_EQ(scalarIndex, expected);
+        }
+
+        for (const auto classify : getClassifiers())
+        {
+            std::vector<uint32_t> index;
+            EXPECT_EQ(pods::details::buildJsonIndex(json.data(), json.size(), index, classify, hasBackslashes), closed);
+            EXPECT_EQ(index, scalarIndex);
+        }
+    }
+}
+
+TEST(jsonIndex, testInvalidStrings)
+{
+    std::vector<uint32_t> index;
+    bool hasBackslashes = false;
+
+    const std::string unclosed = R"({"a":"b)";
+    EXPECT_FALSE(pods::details::buildJsonIndex(unclosed.data(), unclosed.size(), index, hasBackslashes));
+
+    const std::string control = "{\"a\":\"b\nc\"}";
+    EXPECT_FALSE(pods::details::buildJsonIndex(control.data(), control.size(), index, hasBackslashes));
+}
+
+TEST(jsonIndex, testRoundTrip)
+{
+    const auto expected = makeDocument();
+
+    pods::ResizableOutputBuffer out;
+    pods::JsonSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    const std::string json(out.data(), out.size());
+
+    Document actual;
+    EXPECT_EQ(load(json, actual), pods::Error::NoError);
+    EXPECT_EQ(actual, expected);
+
+    Document reference;
+    pods::InputBuffer in(json.data(), json.size());
+    pods::JsonDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(reference), pods::Error::NoError);
+    EXPECT_EQ(actual, reference);
+}
+
+TEST(jsonIndex, testAnyOrder)
+{
+    const std::string json = R"( {
+        "extra": { "x": [1, { "y": null }, "A"], "z": -0.5e+3 },
+        "matrix": [[7]], "points": [], "tags": { "\u00e9\ud83d\ude00": "\/" },
+        "blob": "", "scale": 1, "ratio": 2.0, "ok": false, "small": 127, "id": 0
+    } )";
+
+    Document document;
+    EXPECT_EQ(load(json, document), pods::Error::NoError);
+
+    EXPECT_EQ(document.matrix, std::vector<std::vector<int32_t>>({ { 7 } }));
+    EXPECT_EQ(document.tags.at("\xc3\xa9\xf0\x9f\x98\x80"), "/");
+    EXPECT_EQ(document.scale, 1.0f);
+    EXPECT_EQ(document.small, 127);
+}
+
+TEST(jsonIndex, testStorage)
+{
+    const std::string json = R"({"x":1,"y":2} {"x":3,"y":4})";
+
+    pods::InputBuffer in(json.data(), json.size());
+    pods::JsonIndexedDeserializer<decltype(in)> deserializer(in);
+
+    Point point;
+    EXPECT_EQ(deserializer.load(point), pods::Error::NoError);
+    EXPECT_EQ(point, Point({ 1, 2 }));
+    EXPECT_EQ(in.available(), 13u);
+
+    EXPECT_EQ(deserializer.load(point), pods::Error::NoError);
+    EXPECT_EQ(point, Point({ 3, 4 }));
+    EXPECT_EQ(in.available(), 0u);
+}
+
+TEST(jsonIndex, testCorrupted)
+{
+    const char* const invalid[] =
+    {
+        R"({"x":1 "y":2})",
+        R"({"x":1,"y":2,})",
+        R"({"x":1,"y":2])",
+        R"({"x" 1,"y":2})",
+        R"({"x":01,"y":2})",
+        R"({"x":1.5,"y":2})",
+        R"({"x":1,"y":2x})",
+        R"({"x":1,"y":"2"})",
+        R"({"x":1,"y":99999999999})",
+        R"({"x":1,"y":)",
+        R"({"x":1,"y":2,"z":[1,2})",
+        R"({"x":1,"y":2,"z":tru})",
+        R"({"x":1,"y":2,"z":[1,}]})",
+        R"({"x":1,"y":2)",
+        R"([)"
+    };
+
+    for (const auto json : invalid)
+    {
+        const std::string str(json);
+        pods::InputBuffer in(str.data(), str.size());
+        pods::JsonIndexedDeserializer<decltype(in)> deserializer(in);
+
+        Point point;
+        EXPECT_NE(deserializer.load(point), pods::Error::NoError) << json;
+    }
+
+    Document document;
+    EXPECT_EQ(load(R"({"name":"\x"})", document), pods::Error::CorruptedArchive);
+    EXPECT_EQ(load(R"({"name":"\ud83d"})", document), pods::Error::CorruptedArchive);
+}
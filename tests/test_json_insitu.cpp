@@ -0,0 +1,88 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/json.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Record
+    {
+        int32_t id = 0;
+        std::string_view name;
+        std::string comment;
+        std::vector<std::string_view> tags;
+
+        PODS_SERIALIZABLE(PODS_MDR(id), PODS_MDR(name), PODS_OPT(comment), PODS_MDR(tags))
+    };
+
+    bool isInside(std::string_view value, const std::string& buffer)
+    {
+        return value.data() >= buffer.data() && value.data() + value.size() <= buffer.data() + buffer.size();
+    }
+}
+
+TEST(jsonInsitu, testZeroCopy)
+{
+    std::string json = R"({"tags":["a","b\tc"],"extra":{"x":"y"},"name":"quote \" and é","id":7,"comment":"copied"})";
+
+    Record record;
+
+    pods::InsituInputBuffer in(json.data(), json.size());
+    pods::JsonInsituDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(record), pods::Error::NoError);
+
+    EXPECT_EQ(record.id, 7);
+    EXPECT_EQ(record.name, "quote \" and \xc3\xa9");
+    EXPECT_EQ(record.comment, "copied");
+    ASSERT_EQ(record.tags.size(), 2);
+    EXPECT_EQ(record.tags[0], "a");
+    EXPECT_EQ(record.tags[1], "b\tc");
+
+    EXPECT_TRUE(isInside(record.name, json));
+    EXPECT_TRUE(isInside(record.tags[0], json));
+    EXPECT_TRUE(isInside(record.tags[1], json));
+    EXPECT_EQ(in.available(), 0u);
+}
+
+TEST(jsonInsitu, testRoundTrip)
+{
+    const std::string tag = "tag";
+
+    Record expected;
+    expected.id = -1;
+    expected.name = "name\n";
+    expected.tags = { tag, tag };
+
+    pods::ResizableOutputBuffer out;
+    pods::JsonSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    std::string json(out.data(), out.size());
+
+    Record actual;
+
+    pods::InsituInputBuffer in(json.data(), json.size());
+    pods::JsonInsituDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+
+    EXPECT_EQ(actual.id, expected.id);
+    EXPECT_EQ(actual.name, expected.name);
+    EXPECT_EQ(actual.comment, expected.comment);
+    EXPECT_EQ(actual.tags, expected.tags);
+}
+
+TEST(jsonInsitu, testCorrupted)
+{
+    std::string json = R"({"id":1,"name":"unterminated)";
+
+    Record record;
+
+    pods::InsituInputBuffer in(json.data(), json.size());
+    pods::JsonInsituDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(record), pods::Error::CorruptedArchive);
+}
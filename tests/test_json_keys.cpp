@@ -0,0 +1,111 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/details/field_table.h>
+#include <pods/json.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Point
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y))
+    };
+
+    // the same types of the fields as Point
+    struct Size
+    {
+        int32_t w = 0;
+        int32_t h = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(w), PODS_MDR(h))
+    };
+
+    struct Shape
+    {
+        Point center;
+        Size size;
+        std::string name = "default";
+        std::vector<Point> points;
+
+        PODS_SERIALIZABLE(PODS_MDR(center), PODS_MDR(size), PODS_OPT(name), PODS_MDR(points))
+    };
+
+    pods::Error load(const std::string& json, Shape& shape)
+    {
+        pods::InputBuffer in(json.data(), json.size());
+        pods::JsonDeserializer<decltype(in)> deserializer(in);
+        return deserializer.load(shape);
+    }
+}
+
+TEST(jsonKeys, testAnyOrder)
+{
+    const std::string json = R"({"points":[{"y":2,"x":1},{"x":3,"y":4}],"name":"box","size":{"h":20,"w":10},"center":{"y":-5,"x":5}})";
+
+    Shape shape;
+    EXPECT_EQ(load(json, shape), pods::Error::NoError);
+
+    EXPECT_EQ(shape.center.x, 5);
+    EXPECT_EQ(shape.center.y, -5);
+    EXPECT_EQ(shape.size.w, 10);
+    EXPECT_EQ(shape.size.h, 20);
+    EXPECT_EQ(shape.name, "box");
+    ASSERT_EQ(shape.points.size(), 2);
+    EXPECT_EQ(shape.points[0].x, 1);
+    EXPECT_EQ(shape.points[0].y, 2);
+    EXPECT_EQ(shape.points[1].y, 4);
+}
+
+TEST(jsonKeys, testUnknownKeys)
+{
+    const std::string json = R"({"id":1,"center":{"z":[1,{"a":[]}],"x":5,"y":6},"tags":{"a":null,"b":[true,false]},"size":{"w":1,"h":2},"points":[],"extra":"x"})";
+
+    Shape shape;
+    EXPECT_EQ(load(json, shape), pods::Error::NoError);
+
+    EXPECT_EQ(shape.center.x, 5);
+    EXPECT_EQ(shape.center.y, 6);
+    EXPECT_EQ(shape.size.h, 2);
+    EXPECT_EQ(shape.name, "default");
+}
+
+TEST(jsonKeys, testMissingKeys)
+{
+    Shape shape;
+    EXPECT_EQ(load(R"({"size":{"w":1,"h":2},"center":{"x":5,"y":6}})", shape), pods::Error::MandatoryFieldMissed);
+    EXPECT_EQ(load(R"({"size":{"w":1},"center":{"x":5,"y":6},"points":[]})", shape), pods::Error::MandatoryFieldMissed);
+    EXPECT_EQ(load(R"({"size":{"w":1,"h":2},"center":{"x":5,"y":6},"points":[{"x":true,"y":1}]})", shape), pods::Error::CorruptedArchive);
+}
+
+TEST(jsonKeys, testFieldTable)
+{
+    constexpr size_t size = 40;
+
+    std::vector<std::string> names;
+    uint32_t hashes[size] = {};
+    for (size_t i = 0; i < size; ++i)
+    {
+        names.push_back("field" + std::to_string(i));
+        hashes[i] = pods::details::hashName(names.back());
+    }
+
+    const pods::details::FieldTable<size> table(hashes);
+    for (size_t i = 0; i < size; ++i)
+    {
+        EXPECT_EQ(table.find(hashes[i]), i);
+    }
+
+    // the same hash twice, the table falls back to the search
+    hashes[1] = hashes[0];
+    const pods::details::FieldTable<size> collided(hashes);
+    EXPECT_EQ(collided.find(hashes[0]), 0);
+    EXPECT_EQ(collided.find(hashes[2]), 2);
+    EXPECT_EQ(collided.find(pods::details::hashName("unknown")), size);
+}
@@ -0,0 +1,88 @@
+﻿#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/mapped_file.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Snapshot
+    {
+        std::string name = "snapshot";
+        std::vector<uint64_t> values = { 1, 2, 0xffffffffffff, 4 };
+
+        PODS_SERIALIZABLE(PODS_MDR(name), PODS_MDR(values))
+    };
+
+    struct SnapshotView
+    {
+        std::string_view name;
+        std::vector<uint64_t> values;
+
+        PODS_SERIALIZABLE(PODS_MDR(name), PODS_MDR(values))
+    };
+
+    std::string writeFile(const char* fileName, const char* data, size_t size)
+    {
+        const auto path = (std::filesystem::temp_directory_path() / fileName).string();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data, static_cast<std::streamsize>(size));
+        return path;
+    }
+}
+
+TEST(mappedFile, testMsgPack)
+{
+    const Snapshot expected;
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    const auto path = writeFile("pods_test_mapped_file.bin", out.data(), out.size());
+
+    {
+        pods::MappedInputFile in(path);
+        EXPECT_EQ(in.size(), out.size());
+
+        SnapshotView actual;
+        pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+        EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+
+        EXPECT_EQ(expected.name, actual.name);
+        EXPECT_EQ(expected.values, actual.values);
+
+        EXPECT_GE(actual.name.data(), in.data());
+        EXPECT_LT(actual.name.data(), in.data() + in.size());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(mappedFile, testEmpty)
+{
+    const auto path = writeFile("pods_test_mapped_file_empty.bin", nullptr, 0);
+
+    {
+        pods::MappedInputFile in(path);
+        EXPECT_EQ(in.size(), 0);
+
+        uint8_t n = 0;
+        EXPECT_EQ(in.get(n), pods::Error::UnexpectedEnd);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(mappedFile, testNoFile)
+{
+    const auto path = (std::filesystem::temp_directory_path() / "pods_test_mapped_file_none.bin").string();
+    EXPECT_THROW(pods::MappedInputFile in(path), std::system_error);
+}
@@ -0,0 +1,112 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/msgpack_array_index.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Record
+    {
+        uint32_t id = 0;
+        std::string name;
+        std::vector<int64_t> values;
+
+        PODS_SERIALIZABLE(PODS_MDR(id), PODS_MDR(name), PODS_MDR(values))
+    };
+
+    struct Table
+    {
+        std::vector<Record> records;
+
+        PODS_SERIALIZABLE(PODS_MDR(records))
+    };
+
+    std::string save(size_t size)
+    {
+        Table table;
+        for (size_t i = 0; i < size; ++i)
+        {
+            const auto id = static_cast<uint32_t>(i);
+            table.records.push_back(Record{ id, std::string(i % 40, 'x'), std::vector<int64_t>(i % 5, -int64_t(i) * 1000) });
+        }
+
+        pods::ResizableOutputBuffer out;
+        pods::MsgPackSerializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(table), pods::Error::NoError);
+        return std::string(out.data(), out.size());
+    }
+}
+
+TEST(msgpackArrayIndex, testLoad)
+{
+    constexpr size_t size = 1000;
+    const auto data = save(size);
+
+    pods::MsgPackArrayIndex<Record> index;
+    EXPECT_EQ(index.build(data.data(), data.size()), pods::Error::NoError);
+    EXPECT_EQ(index.size(), size);
+
+    Record record;
+    EXPECT_EQ(index.loadElement(data.data(), data.size(), 999, record), pods::Error::NoError);
+    EXPECT_EQ(record.id, 999);
+    EXPECT_EQ(record.name.size(), 999 % 40);
+    ASSERT_EQ(record.values.size(), 999 % 5);
+    EXPECT_EQ(record.values[0], -999000);
+
+    EXPECT_EQ(index.loadElement(data.data(), data.size(), 0, record), pods::Error::NoError);
+    EXPECT_EQ(record.id, 0);
+    EXPECT_TRUE(record.name.empty());
+
+    std::vector<Record> records;
+    EXPECT_EQ(index.loadRange(data.data(), data.size(), 500, 510, records), pods::Error::NoError);
+    ASSERT_EQ(records.size(), 10);
+    EXPECT_EQ(records[0].id, 500);
+    EXPECT_EQ(records[9].id, 509);
+    EXPECT_EQ(records[9].name.size(), 509 % 40);
+
+    EXPECT_EQ(index.loadRange(data.data(), data.size(), 10, 10, records), pods::Error::NoError);
+    EXPECT_TRUE(records.empty());
+
+    EXPECT_EQ(index.loadElement(data.data(), data.size(), size, record), pods::Error::InvalidSize);
+    EXPECT_EQ(index.loadRange(data.data(), data.size(), 10, 5, records), pods::Error::InvalidSize);
+    EXPECT_EQ(index.loadElement(data.data(), data.size() / 2, 999, record), pods::Error::CorruptedArchive);
+}
+
+TEST(msgpackArrayIndex, testSidecar)
+{
+    const auto data = save(100);
+
+    pods::MsgPackArrayIndex<Record> index;
+    EXPECT_EQ(index.build(data.data(), data.size()), pods::Error::NoError);
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(index), pods::Error::NoError);
+
+    pods::MsgPackArrayIndex<Record> loaded;
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(loaded), pods::Error::NoError);
+    EXPECT_EQ(loaded.size(), 100);
+
+    Record record;
+    EXPECT_EQ(loaded.loadElement(data.data(), data.size(), 42, record), pods::Error::NoError);
+    EXPECT_EQ(record.id, 42);
+}
+
+TEST(msgpackArrayIndex, testCorrupted)
+{
+    const auto data = save(100);
+
+    pods::MsgPackArrayIndex<Record> index;
+    EXPECT_EQ(index.build(data.data(), data.size() - 1), pods::Error::UnexpectedEnd);
+
+    // an array of thousands of items in 3 bytes
+    const char huge[] = "\xdc\x94\x88";
+    EXPECT_EQ(index.build(huge, 3), pods::Error::CorruptedArchive);
+}
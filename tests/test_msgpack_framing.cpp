@@ -0,0 +1,174 @@
+﻿#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+#include <pods/streams.h>
+
+namespace
+{
+    struct Point
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y))
+    };
+
+    struct PointV2
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        std::string label = "label";
+        std::vector<Point> children = { Point{ 1, 2 }, Point{ 3, 4 } };
+        std::map<std::string, double> tags = { { "a", 1.5 }, { "b", -2.5 } };
+        bool visible = true;
+
+        PODS_SERIALIZABLE(
+            PODS_MDR(x),
+            PODS_MDR(y),
+            PODS_MDR(label),
+            PODS_MDR(children),
+            PODS_MDR(tags),
+            PODS_MDR(visible))
+    };
+
+    struct PointV3
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        std::string label = "default";
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y), PODS_OPT(label))
+    };
+
+    struct StrictPointV3
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        std::string label = "default";
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y), PODS_MDR(label))
+    };
+
+    template <class P>
+    struct Shape
+    {
+        P center;
+        std::vector<P> points;
+        int64_t id = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(center), PODS_MDR(points), PODS_MDR(id))
+    };
+
+    template <class T>
+    std::string save(const T& data)
+    {
+        pods::ResizableOutputBuffer out;
+        pods::FramedMsgPackSerializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(data), pods::Error::NoError);
+        return std::string(out.data(), out.size());
+    }
+
+    template <class T>
+    pods::Error load(const std::string& data, T& result)
+    {
+        pods::InputBuffer in(data.data(), data.size());
+        pods::FramedMsgPackDeserializer<decltype(in)> deserializer(in);
+        const auto error = deserializer.load(result);
+        EXPECT_TRUE(error != pods::Error::NoError || in.available() == 0);
+        return error;
+    }
+}
+
+TEST(msgpackFraming, testLayout)
+{
+    const Point point { 1, 2 };
+    const auto data = save(point);
+
+    ASSERT_EQ(data.size(), 3);
+    EXPECT_EQ(static_cast<uint8_t>(data[0]), 0x92);
+    EXPECT_EQ(data[1], 1);
+    EXPECT_EQ(data[2], 2);
+}
+
+TEST(msgpackFraming, testSkipTrailingFields)
+{
+    Shape<PointV2> expected;
+    expected.center.x = 10;
+    expected.points.resize(3);
+    expected.points[2].y = -7;
+    expected.id = 100500;
+
+    Shape<Point> actual;
+    EXPECT_EQ(load(save(expected), actual), pods::Error::NoError);
+
+    EXPECT_EQ(actual.center.x, 10);
+    ASSERT_EQ(actual.points.size(), 3);
+    EXPECT_EQ(actual.points[2].y, -7);
+    EXPECT_EQ(actual.id, 100500);
+}
+
+TEST(msgpackFraming, testMissingTrailingFields)
+{
+    Shape<Point> expected;
+    expected.center.y = 5;
+    expected.points.resize(2);
+    expected.id = 42;
+
+    const auto data = save(expected);
+
+    Shape<PointV3> actual;
+    EXPECT_EQ(load(data, actual), pods::Error::NoError);
+    EXPECT_EQ(actual.center.y, 5);
+    EXPECT_EQ(actual.center.label, "default");
+    EXPECT_EQ(actual.points.size(), 2);
+    EXPECT_EQ(actual.id, 42);
+
+    Shape<StrictPointV3> strict;
+    EXPECT_EQ(load(data, strict), pods::Error::MandatoryFieldMissed);
+}
+
+TEST(msgpackFraming, testSkipValue)
+{
+    const auto data = save(Shape<PointV2>());
+
+    {
+        pods::InputBuffer in(data.data(), data.size());
+        pods::details::MsgPackInput<decltype(in)> input(in);
+        EXPECT_EQ(input.skipValue(), pods::Error::NoError);
+        EXPECT_EQ(in.available(), 0);
+        EXPECT_EQ(input.skipValue(), pods::Error::UnexpectedEnd);
+    }
+
+    {
+        std::stringstream buffer(data);
+        pods::InputStream in(buffer);
+        pods::details::MsgPackInput<decltype(in)> input(in);
+        EXPECT_EQ(input.skipValue(), pods::Error::NoError);
+        EXPECT_EQ(input.skipValue(), pods::Error::UnexpectedEnd);
+    }
+}
+
+TEST(msgpackFraming, testSkipForeignValues)
+{
+    // nil, fixext 4, ext 8 with 3 bytes, positive fixint
+    const char data[] = "\xc0\xd6\x01\x01\x02\x03\x04\xc7\x03\x05\x01\x02\x03\x07";
+
+    pods::InputBuffer in(data, sizeof(data) - 1);
+    pods::details::MsgPackInput<decltype(in)> input(in);
+    EXPECT_EQ(input.skipValue(), pods::Error::NoError);
+    EXPECT_EQ(input.skipValue(), pods::Error::NoError);
+    EXPECT_EQ(input.skipValue(), pods::Error::NoError);
+    EXPECT_EQ(in.available(), 1);
+
+    const char invalid[] = "\xc1";
+    pods::InputBuffer invalidIn(invalid, 1);
+    pods::details::MsgPackInput<decltype(invalidIn)> invalidInput(invalidIn);
+    EXPECT_EQ(invalidInput.skipValue(), pods::Error::CorruptedArchive);
+}
@@ -0,0 +1,205 @@
+﻿#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Point
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(y))
+    };
+
+    struct ReversedPoint
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(y), PODS_MDR(x))
+    };
+
+    struct PointV2
+    {
+        std::string label = "label";
+        int32_t x = 0;
+        std::map<std::string, double> tags = { { "a", 1.5 }, { "b", -2.5 } };
+        int32_t y = 0;
+        std::vector<Point> children = { Point{ 1, 2 }, Point{ 3, 4 } };
+
+        PODS_SERIALIZABLE(
+            PODS_MDR(label),
+            PODS_MDR(x),
+            PODS_MDR(tags),
+            PODS_MDR(y),
+            PODS_MDR(children))
+    };
+
+    struct PointV3
+    {
+        int32_t x = 0;
+        std::string label = "default";
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_OPT(label), PODS_MDR(y))
+    };
+
+    struct StrictPointV3
+    {
+        int32_t x = 0;
+        std::string label = "default";
+        int32_t y = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_MDR(label), PODS_MDR(y))
+    };
+
+    // the 16-bit ids of the names are the same
+    struct Collision
+    {
+        int32_t aab = 0;
+        int32_t al5 = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(aab), PODS_MDR(al5))
+    };
+
+    template <class P>
+    struct Shape
+    {
+        P center;
+        std::vector<P> points;
+        int64_t id = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(center), PODS_MDR(points), PODS_MDR(id))
+    };
+
+    template <class T>
+    std::string save(const T& data)
+    {
+        pods::ResizableOutputBuffer out;
+        pods::KeyedMsgPackSerializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(data), pods::Error::NoError);
+        return std::string(out.data(), out.size());
+    }
+
+    template <class T>
+    pods::Error load(const std::string& data, T& result)
+    {
+        pods::InputBuffer in(data.data(), data.size());
+        pods::KeyedMsgPackDeserializer<decltype(in)> deserializer(in);
+        const auto error = deserializer.load(result);
+        EXPECT_TRUE(error != pods::Error::NoError || in.available() == 0);
+        return error;
+    }
+}
+
+TEST(msgpackKeyed, testLayout)
+{
+    const Point point { 1, 2 };
+    const auto data = save(point);
+
+    constexpr auto x = pods::details::msgpack::fieldId("x");
+    constexpr auto y = pods::details::msgpack::fieldId("y");
+    static_assert(x != y);
+    static_assert(pods::details::msgpack::fieldId("\0x") == x);
+
+    ASSERT_EQ(data.size(), 9);
+    EXPECT_EQ(static_cast<uint8_t>(data[0]), 0x82);
+
+    EXPECT_EQ(static_cast<uint8_t>(data[1]), pods::details::msgpack::UInt16);
+    uint16_t id = 0;
+    memcpy(&id, data.data() + 2, sizeof(id));
+    EXPECT_EQ(pods::details::fromBigEndian(id), x);
+    EXPECT_EQ(data[4], 1);
+
+    EXPECT_EQ(static_cast<uint8_t>(data[5]), pods::details::msgpack::UInt16);
+    memcpy(&id, data.data() + 6, sizeof(id));
+    EXPECT_EQ(pods::details::fromBigEndian(id), y);
+    EXPECT_EQ(data[8], 2);
+}
+
+TEST(msgpackKeyed, testReorderedFields)
+{
+    Shape<Point> expected;
+    expected.center = { 1, -2 };
+    expected.points = { { 3, 4 }, { -5, 6 } };
+    expected.id = 100500;
+
+    Shape<ReversedPoint> actual;
+    EXPECT_EQ(load(save(expected), actual), pods::Error::NoError);
+
+    EXPECT_EQ(actual.center.x, 1);
+    EXPECT_EQ(actual.center.y, -2);
+    ASSERT_EQ(actual.points.size(), 2);
+    EXPECT_EQ(actual.points[1].x, -5);
+    EXPECT_EQ(actual.points[1].y, 6);
+    EXPECT_EQ(actual.id, 100500);
+}
+
+TEST(msgpackKeyed, testSkipUnknownFields)
+{
+    Shape<PointV2> expected;
+    expected.center.x = 10;
+    expected.points.resize(3);
+    expected.points[2].y = -7;
+    expected.id = 42;
+
+    Shape<Point> actual;
+    EXPECT_EQ(load(save(expected), actual), pods::Error::NoError);
+
+    EXPECT_EQ(actual.center.x, 10);
+    ASSERT_EQ(actual.points.size(), 3);
+    EXPECT_EQ(actual.points[2].y, -7);
+    EXPECT_EQ(actual.id, 42);
+}
+
+TEST(msgpackKeyed, testMissingFields)
+{
+    Shape<Point> expected;
+    expected.center = { 3, 5 };
+    expected.points.resize(2);
+    expected.id = 42;
+
+    const auto data = save(expected);
+
+    Shape<PointV3> actual;
+    EXPECT_EQ(load(data, actual), pods::Error::NoError);
+    EXPECT_EQ(actual.center.x, 3);
+    EXPECT_EQ(actual.center.y, 5);
+    EXPECT_EQ(actual.center.label, "default");
+    EXPECT_EQ(actual.points.size(), 2);
+    EXPECT_EQ(actual.id, 42);
+
+    Shape<StrictPointV3> strict;
+    EXPECT_EQ(load(data, strict), pods::Error::MandatoryFieldMissed);
+}
+
+TEST(msgpackKeyed, testInvalidKey)
+{
+    // a map with a string key
+    const std::string data("\x81\xa1x\x01", 4);
+
+    Point actual;
+    EXPECT_EQ(load(data, actual), pods::Error::CorruptedArchive);
+}
+
+TEST(msgpackKeyed, testFieldIdCollision)
+{
+    static_assert(pods::details::msgpack::fieldId("aab") == pods::details::msgpack::fieldId("al5"));
+
+    pods::ResizableOutputBuffer out;
+    pods::KeyedMsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(Collision()), pods::Error::FieldIdCollision);
+
+    const auto data = save(Point());
+
+    Collision actual;
+    EXPECT_EQ(load(data, actual), pods::Error::FieldIdCollision);
+}
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
 #include <pods/buffers.h>
 #include <pods/msgpack.h>
 #include <pods/pods.h>
@@ -129,3 +134,186 @@ TEST(msgpackSerializer, testUIntSizes)
     check<UInt64, UInt16>(max2byte);
     check<UInt64, UInt32>(max4byte);
 }
+
+struct BigArray
+{
+    std::vector<uint8_t> x = std::vector<uint8_t>(std::numeric_limits<uint16_t>::max() + 1, 1);
+    PODS_SERIALIZABLE(PODS_MDR(x))
+};
+
+TEST(msgpackSerializer, testSize32)
+{
+    const BigArray expected;
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    // the wire size is always 32 bits whatever pods::Size is
+    const size_t headerSize = 1 + sizeof(uint32_t);
+    EXPECT_EQ(out.size(), headerSize + expected.x.size());
+    EXPECT_EQ(static_cast<uint8_t>(out.data()[0]), 0xdd);
+
+    BigArray actual;
+    actual.x.clear();
+
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+    EXPECT_EQ(expected.x, actual.x);
+}
+
+template <class T>
+struct ContiguousNumbers
+{
+    std::vector<T> x;
+    PODS_SERIALIZABLE(PODS_MDR(x))
+};
+
+template <class T>
+struct LinkedNumbers
+{
+    std::list<T> x;
+    PODS_SERIALIZABLE(PODS_MDR(x))
+};
+
+template <class T, class Data>
+std::string save(const Data& data)
+{
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(data), pods::Error::NoError);
+    return std::string(out.data(), out.size());
+}
+
+// the contiguous arrays are encoded by blocks, the lists are encoded value by value
+template <class T>
+void checkNumbers(const std::vector<T>& values)
+{
+    const ContiguousNumbers<T> contiguous { values };
+    const LinkedNumbers<T> linked { std::list<T>(values.begin(), values.end()) };
+
+    const auto expected = save<T>(linked);
+    EXPECT_EQ(expected, save<T>(contiguous));
+
+    // the contiguous arrays are decoded by runs of the same tag
+    ContiguousNumbers<T> actual;
+    pods::InputBuffer in(expected.data(), expected.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+    EXPECT_EQ(values, actual.x);
+
+    LinkedNumbers<T> linkedActual;
+    pods::InputBuffer linkedIn(expected.data(), expected.size());
+    pods::MsgPackDeserializer<decltype(linkedIn)> linkedDeserializer(linkedIn);
+    EXPECT_EQ(linkedDeserializer.load(linkedActual), pods::Error::NoError);
+    EXPECT_EQ(linked.x, linkedActual.x);
+}
+
+template <class T>
+void checkNumbers()
+{
+    using Limits = std::numeric_limits<T>;
+
+    std::mt19937_64 random(42);
+    std::vector<T> mixed(1000);
+    for (auto& value : mixed)
+    {
+        // random bit widths to hit every encoding
+        const auto bits = random() % (sizeof(T) * 8);
+        value = static_cast<T>(random() >> (63 - bits));
+    }
+    mixed.push_back(Limits::min());
+    mixed.push_back(Limits::max());
+    mixed.push_back(Limits::lowest());
+    checkNumbers(mixed);
+
+    checkNumbers(std::vector<T>(700, static_cast<T>(5)));
+    checkNumbers(std::vector<T>(700, Limits::max()));
+    checkNumbers(std::vector<T>(700, Limits::lowest()));
+    checkNumbers(std::vector<T>());
+}
+
+TEST(msgpackSerializer, testNumberArrays)
+{
+    checkNumbers<int8_t>();
+    checkNumbers<uint8_t>();
+    checkNumbers<int16_t>();
+    checkNumbers<uint16_t>();
+    checkNumbers<int32_t>();
+    checkNumbers<uint32_t>();
+    checkNumbers<int64_t>();
+    checkNumbers<uint64_t>();
+    checkNumbers<float>();
+    checkNumbers<double>();
+}
+
+TEST(msgpackSerializer, testNumberArrayErrors)
+{
+    const ContiguousNumbers<int32_t> wide { { -1, 5, 100000, -5 } };
+    const auto data = save<int32_t>(wide);
+
+    {
+        ContiguousNumbers<int16_t> narrow;
+        pods::InputBuffer in(data.data(), data.size());
+        pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+        EXPECT_EQ(deserializer.load(narrow), pods::Error::CorruptedArchive);
+    }
+
+    {
+        ContiguousNumbers<uint32_t> unsignedNumbers;
+        pods::InputBuffer in(data.data(), data.size());
+        pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+        EXPECT_EQ(deserializer.load(unsignedNumbers), pods::Error::CorruptedArchive);
+    }
+
+    {
+        ContiguousNumbers<int32_t> truncated;
+        pods::InputBuffer in(data.data(), data.size() - 2);
+        pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+        EXPECT_EQ(deserializer.load(truncated), pods::Error::UnexpectedEnd);
+    }
+}
+
+struct FixedLayout
+{
+    int8_t a = 1;
+    uint16_t b = 2;
+    int32_t c = -3;
+    uint64_t d = 4;
+    std::string e = "e";
+    std::vector<int32_t> f = { 1, -1000, 100000 };
+
+    PODS_SERIALIZABLE(PODS_MDR(a), PODS_MDR(b), PODS_MDR(c), PODS_MDR(d), PODS_MDR(e), PODS_MDR(f))
+};
+
+TEST(msgpackSerializer, testFixedWidth)
+{
+    const FixedLayout expected;
+
+    pods::ResizableOutputBuffer out;
+    pods::FixedWidthMsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    const size_t stringSize = 1 + sizeof(uint32_t) + expected.e.size();
+    const size_t arraySize = 1 + sizeof(uint32_t) + expected.f.size() * (1 + sizeof(int32_t));
+    EXPECT_EQ(out.size(), 2 + 3 + 5 + 9 + stringSize + arraySize);
+
+    FixedLayout actual;
+    actual.a = 0;
+    actual.b = 0;
+    actual.c = 0;
+    actual.d = 0;
+    actual.e.clear();
+    actual.f.clear();
+
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+    EXPECT_EQ(expected.a, actual.a);
+    EXPECT_EQ(expected.b, actual.b);
+    EXPECT_EQ(expected.c, actual.c);
+    EXPECT_EQ(expected.d, actual.d);
+    EXPECT_EQ(expected.e, actual.e);
+    EXPECT_EQ(expected.f, actual.f);
+}
@@ -0,0 +1,138 @@
+﻿#include <gtest/gtest.h>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/msgpack_view.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Route
+    {
+        std::string host;
+        uint16_t port = 0;
+
+        PODS_SERIALIZABLE(PODS_MDR(host), PODS_MDR(port))
+    };
+
+    struct Message
+    {
+        uint64_t id = 0;
+        Route route;
+        std::vector<Route> hops;
+        std::string topic;
+        std::vector<int32_t> payload;
+        char key[4] = {};
+        double priority = 0;
+
+        PODS_SERIALIZABLE(
+            PODS_MDR(id),
+            PODS_MDR(route),
+            PODS_MDR(hops),
+            PODS_MDR(topic),
+            PODS_MDR_BIN(payload),
+            PODS_MDR_BIN(key),
+            PODS_MDR(priority))
+    };
+
+    std::string save()
+    {
+        Message message;
+        message.id = 100500;
+        message.route = { "localhost", 8080 };
+        message.hops = { { "a", 1 }, { "b", 2 } };
+        message.topic = "orders";
+        message.payload = { 1, 2, 3 };
+        message.key[0] = 'k';
+        message.priority = 0.5;
+
+        pods::ResizableOutputBuffer out;
+        pods::MsgPackSerializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(message), pods::Error::NoError);
+        return std::string(out.data(), out.size());
+    }
+}
+
+TEST(msgpackView, testGet)
+{
+    const auto data = save();
+
+    pods::MsgPackView<Message> view(data.data(), data.size());
+
+    double priority = 0;
+    EXPECT_EQ(view.get(&Message::priority, priority), pods::Error::NoError);
+    EXPECT_EQ(priority, 0.5);
+
+    std::string_view topic;
+    EXPECT_EQ(view.get(&Message::topic, topic), pods::Error::NoError);
+    EXPECT_EQ(topic, "orders");
+    EXPECT_GE(topic.data(), data.data());
+    EXPECT_LT(topic.data(), data.data() + data.size());
+
+    uint64_t id = 0;
+    EXPECT_EQ(view.get(&Message::id, id), pods::Error::NoError);
+    EXPECT_EQ(id, 100500);
+
+    Route route;
+    EXPECT_EQ(view.get(&Message::route, route), pods::Error::NoError);
+    EXPECT_EQ(route.host, "localhost");
+    EXPECT_EQ(route.port, 8080);
+
+    std::vector<Route> hops;
+    EXPECT_EQ(view.get(&Message::hops, hops), pods::Error::NoError);
+    ASSERT_EQ(hops.size(), 2);
+    EXPECT_EQ(hops[1].host, "b");
+
+    std::span<const char> payload;
+    EXPECT_EQ(view.get(&Message::payload, payload), pods::Error::NoError);
+    EXPECT_EQ(payload.size(), 3 * sizeof(int32_t));
+
+    std::span<const char> key;
+    EXPECT_EQ(view.get(&Message::key, key), pods::Error::NoError);
+    ASSERT_EQ(key.size(), 4);
+    EXPECT_EQ(key[0], 'k');
+}
+
+TEST(msgpackView, testCachedFields)
+{
+    const auto data = save();
+
+    pods::InputBuffer in(data.data(), data.size());
+
+    pods::MsgPackView<Message> view(in);
+    EXPECT_EQ(in.available(), 0);
+
+    // the offsets of all the fields are cached by the first get() of the last one
+    double priority = 0;
+    EXPECT_EQ(view.get(&Message::priority, priority), pods::Error::NoError);
+    EXPECT_EQ(priority, 0.5);
+
+    std::string_view topic;
+    EXPECT_EQ(view.get(&Message::topic, topic), pods::Error::NoError);
+    EXPECT_EQ(topic, "orders");
+
+    priority = 0;
+    EXPECT_EQ(view.get(&Message::priority, priority), pods::Error::NoError);
+    EXPECT_EQ(priority, 0.5);
+}
+
+TEST(msgpackView, testCorrupted)
+{
+    const auto data = save();
+
+    pods::MsgPackView<Message> view(data.data(), data.size() / 2);
+
+    uint64_t id = 0;
+    EXPECT_EQ(view.get(&Message::id, id), pods::Error::NoError);
+
+    double priority = 0;
+    EXPECT_EQ(view.get(&Message::priority, priority), pods::Error::UnexpectedEnd);
+
+    std::string topic;
+    EXPECT_EQ(view.get(&Message::id, topic), pods::Error::CorruptedArchive);
+}
@@ -0,0 +1,145 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/parallel.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Record
+    {
+        uint32_t id = 0;
+        std::string name;
+        std::vector<double> values;
+
+        PODS_SERIALIZABLE(PODS_MDR(id), PODS_MDR(name), PODS_MDR(values))
+    };
+
+    struct Table
+    {
+        std::vector<Record> records;
+
+        PODS_SERIALIZABLE(PODS_MDR(records))
+    };
+
+    struct Numbers
+    {
+        std::vector<int32_t> numbers;
+
+        PODS_SERIALIZABLE(PODS_MDR(numbers))
+    };
+
+    Table makeTable(size_t size)
+    {
+        Table table;
+        for (size_t i = 0; i < size; ++i)
+        {
+            const auto id = static_cast<uint32_t>(i);
+            table.records.push_back(Record{ id, std::to_string(i), std::vector<double>(i % 7, static_cast<double>(i) * 0.25) });
+        }
+        return table;
+    }
+
+    std::string save(const Table& table)
+    {
+        pods::ResizableOutputBuffer out;
+        pods::MsgPackSerializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(table), pods::Error::NoError);
+        return std::string(out.data(), out.size());
+    }
+}
+
+TEST(parallel, testLoad)
+{
+    const auto expected = makeTable(10000);
+    const auto data = save(expected);
+
+    for (size_t threads : { 0, 1, 3, 8 })
+    {
+        std::vector<Record> actual;
+        EXPECT_EQ(pods::parallelLoad(data.data(), data.size(), actual, threads), pods::Error::NoError);
+
+        ASSERT_EQ(actual.size(), expected.records.size());
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            EXPECT_EQ(actual[i].id, expected.records[i].id);
+            EXPECT_EQ(actual[i].name, expected.records[i].name);
+            EXPECT_EQ(actual[i].values, expected.records[i].values);
+        }
+    }
+}
+
+TEST(parallel, testEmpty)
+{
+    const auto data = save(Table());
+
+    std::vector<Record> actual(3);
+    EXPECT_EQ(pods::parallelLoad(data.data(), data.size(), actual, 4), pods::Error::NoError);
+    EXPECT_TRUE(actual.empty());
+}
+
+TEST(parallel, testCorrupted)
+{
+    const auto expected = makeTable(1000);
+    auto data = save(expected);
+
+    pods::MsgPackArrayIndex<Record> index;
+    EXPECT_EQ(index.build(data.data(), data.size()), pods::Error::NoError);
+
+    // the name of the last record becomes an array
+    const auto name = data.rfind("\xa3" "999");
+    ASSERT_NE(name, std::string::npos);
+    data[name] = '\x93';
+
+    std::vector<Record> actual;
+    EXPECT_EQ(pods::parallelLoad(index, data.data(), data.size(), actual, 4), pods::Error::CorruptedArchive);
+}
+
+TEST(parallel, testSave)
+{
+    for (size_t size : { 0, 1, 15, 16, 1000, 70000 })
+    {
+        const auto table = makeTable(size);
+        const auto expected = save(table);
+
+        for (size_t threads : { 0, 1, 3, 8 })
+        {
+            pods::ResizableOutputBuffer out;
+            EXPECT_EQ(pods::parallelSave(out, table.records, threads), pods::Error::NoError);
+            EXPECT_EQ(std::string(out.data(), out.size()), expected);
+        }
+    }
+}
+
+TEST(parallel, testSaveNumbers)
+{
+    Numbers numbers;
+    for (int32_t i = -50000; i < 50000; i += 7)
+    {
+        numbers.numbers.push_back(i * (i % 3));
+    }
+
+    pods::ResizableOutputBuffer expected;
+    pods::MsgPackSerializer<decltype(expected)> serializer(expected);
+    EXPECT_EQ(serializer.save(numbers), pods::Error::NoError);
+
+    pods::ResizableOutputBuffer actual;
+    EXPECT_EQ(pods::parallelSave(actual, numbers.numbers, 4), pods::Error::NoError);
+    EXPECT_EQ(std::string(actual.data(), actual.size()), std::string(expected.data(), expected.size()));
+
+    std::vector<int32_t> loaded;
+    EXPECT_EQ(pods::parallelLoad(actual.data(), actual.size(), loaded, 4), pods::Error::NoError);
+    EXPECT_EQ(loaded, numbers.numbers);
+}
+
+TEST(parallel, testSaveOverflow)
+{
+    const auto table = makeTable(1000);
+
+    pods::ResizableOutputBuffer out(16, 1024);
+    EXPECT_EQ(pods::parallelSave(out, table.records, 4), pods::Error::NotEnoughMemory);
+}
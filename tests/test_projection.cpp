@@ -0,0 +1,152 @@
+﻿#include <gtest/gtest.h>
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/json.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+
+namespace
+{
+    struct Item
+    {
+        int32_t id = 0;
+        std::string name;
+        std::vector<double> weights;
+
+        PODS_SERIALIZABLE(PODS_MDR(id), PODS_MDR(name), PODS_MDR(weights))
+    };
+
+    struct Record
+    {
+        std::string title;
+        Item main;
+        std::vector<Item> items;
+        std::map<std::string, Item> index;
+        std::array<Item, 2> fixed;
+        uint32_t bin[4] = {};
+        std::vector<int16_t> binVector;
+        int64_t version = 0;
+        bool active = false;
+
+        PODS_SERIALIZABLE(
+            PODS_MDR(title),
+            PODS_MDR(main),
+            PODS_MDR(items),
+            PODS_MDR(index),
+            PODS_MDR(fixed),
+            PODS_MDR_BIN(bin),
+            PODS_MDR_BIN(binVector),
+            PODS_MDR(version),
+            PODS_OPT(active))
+    };
+
+    Item makeItem(int32_t id)
+    {
+        return Item{ id, "item " + std::to_string(id), { id * 0.5, -id * 1.5 } };
+    }
+
+    Record makeRecord()
+    {
+        Record record;
+        record.title = "title";
+        record.main = makeItem(1);
+        record.items = { makeItem(2), makeItem(3), makeItem(4) };
+        record.index = { { "a", makeItem(5) }, { "b", makeItem(6) } };
+        record.fixed = { makeItem(9), makeItem(10) };
+        record.bin[3] = 11;
+        record.binVector = { 12, 13 };
+        record.version = 14;
+        record.active = true;
+        return record;
+    }
+
+    template <class Serializer, class Deserializer>
+    void testProjection()
+    {
+        pods::ResizableOutputBuffer out;
+        Serializer serializer(out);
+        EXPECT_EQ(serializer.save(makeRecord()), pods::Error::NoError);
+
+        {
+            Record actual;
+
+            pods::InputBuffer in(out.data(), out.size());
+            Deserializer deserializer(in);
+            EXPECT_EQ(deserializer.loadOnly(actual, &Record::version, &Record::main), pods::Error::NoError);
+
+            EXPECT_EQ(actual.version, 14);
+            EXPECT_EQ(actual.main.id, 1);
+            EXPECT_EQ(actual.main.name, "item 1");
+            EXPECT_EQ(actual.main.weights.size(), 2);
+
+            EXPECT_TRUE(actual.title.empty());
+            EXPECT_TRUE(actual.items.empty());
+            EXPECT_TRUE(actual.index.empty());
+            EXPECT_EQ(actual.fixed[1].id, 0);
+            EXPECT_EQ(actual.bin[3], 0);
+            EXPECT_TRUE(actual.binVector.empty());
+            EXPECT_FALSE(actual.active);
+        }
+
+        {
+            Record actual;
+
+            pods::InputBuffer in(out.data(), out.size());
+            Deserializer deserializer(in);
+            EXPECT_EQ(deserializer.loadOnly(actual, &Record::active, &Record::bin, &Record::binVector), pods::Error::NoError);
+
+            EXPECT_TRUE(actual.active);
+            EXPECT_EQ(actual.bin[3], 11);
+            EXPECT_EQ(actual.binVector.size(), 2);
+            EXPECT_EQ(actual.version, 0);
+            EXPECT_EQ(actual.main.id, 0);
+        }
+    }
+}
+
+TEST(projection, testMsgPack)
+{
+    testProjection<pods::MsgPackSerializer<pods::ResizableOutputBuffer>, pods::MsgPackDeserializer<pods::InputBuffer>>();
+}
+
+TEST(projection, testFramedMsgPack)
+{
+    testProjection<pods::FramedMsgPackSerializer<pods::ResizableOutputBuffer>, pods::FramedMsgPackDeserializer<pods::InputBuffer>>();
+}
+
+TEST(projection, testKeyedMsgPack)
+{
+    testProjection<pods::KeyedMsgPackSerializer<pods::ResizableOutputBuffer>, pods::KeyedMsgPackDeserializer<pods::InputBuffer>>();
+}
+
+TEST(projection, testJson)
+{
+    testProjection<pods::JsonSerializer<pods::ResizableOutputBuffer>, pods::JsonDeserializer<pods::InputBuffer>>();
+}
+
+TEST(projection, testSequence)
+{
+    // the projection consumes exactly one record
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(makeRecord()), pods::Error::NoError);
+    EXPECT_EQ(serializer.save(makeRecord()), pods::Error::NoError);
+
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+
+    Record first;
+    EXPECT_EQ(deserializer.loadOnly(first, &Record::title), pods::Error::NoError);
+    EXPECT_EQ(first.title, "title");
+
+    Record second;
+    EXPECT_EQ(deserializer.load(second), pods::Error::NoError);
+    EXPECT_EQ(second.fixed[1].name, "item 10");
+    EXPECT_EQ(second.version, 14);
+    EXPECT_EQ(in.available(), 0);
+}
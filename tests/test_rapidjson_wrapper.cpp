@@ -35,3 +35,77 @@ TEST(rapidJsonWrapper, common)
     EXPECT_EQ(inWrapper.Take(), '\0');
     EXPECT_FALSE(inWrapper.good());
 }
+
+TEST(rapidJsonWrapper, embeddedZero)
+{
+    const char data[] = { 'a', '\0', 'b' };
+
+    pods::InputBuffer in(data, sizeof(data));
+
+    pods::details::InputRapidJsonStreamWrapper<decltype(in)> inWrapper(in);
+
+    EXPECT_EQ(inWrapper.Take(), 'a');
+    EXPECT_EQ(inWrapper.Peek(), '\0');
+    EXPECT_EQ(inWrapper.Peek(), '\0');
+    EXPECT_EQ(inWrapper.Take(), '\0');
+    EXPECT_EQ(inWrapper.Tell(), 2u);
+    EXPECT_EQ(inWrapper.Peek(), 'b');
+    EXPECT_EQ(inWrapper.Take(), 'b');
+    EXPECT_TRUE(inWrapper.good());
+}
+
+TEST(rapidJsonWrapper, memoryStream)
+{
+    const char data[] = { 'a', 'b', 'c' };
+
+    pods::InputBuffer in(data, sizeof(data));
+
+    pods::details::InputRapidJsonMemoryStream<decltype(in)> stream(in);
+
+    EXPECT_EQ(stream.Peek(), 'a');
+    EXPECT_EQ(stream.Take(), 'a');
+    EXPECT_EQ(stream.Tell(), 1u);
+    EXPECT_EQ(in.available(), 3u);
+
+    stream.commit();
+    EXPECT_EQ(in.available(), 2u);
+
+    EXPECT_EQ(stream.Take(), 'b');
+    EXPECT_EQ(stream.Take(), 'c');
+    EXPECT_EQ(stream.Peek(), '\0');
+    EXPECT_EQ(stream.Take(), '\0');
+    EXPECT_EQ(stream.Tell(), 3u);
+
+    stream.commit();
+    EXPECT_EQ(in.available(), 0u);
+}
+
+TEST(rapidJsonWrapper, bulkStream)
+{
+    pods::OutputBuffer out(4);
+
+    pods::details::OutputRapidJsonBulkStream<decltype(out)> stream(out);
+
+    stream.Put('a');
+    pods::details::PutReserve(stream, 2);
+    pods::details::PutUnsafe(stream, 'b');
+    pods::details::PutUnsafe(stream, 'c');
+    EXPECT_EQ(out.size(), 0u);
+
+    stream.Flush();
+    EXPECT_TRUE(stream.good());
+    EXPECT_EQ(std::string(out.data(), out.size()), "abc");
+
+    // more than the free memory is reserved, but less is written
+    pods::details::PutReserve(stream, 6);
+    pods::details::PutUnsafe(stream, 'd');
+
+    stream.Flush();
+    EXPECT_TRUE(stream.good());
+    EXPECT_EQ(std::string(out.data(), out.size()), "abcd");
+
+    stream.Put('e');
+    stream.Flush();
+    EXPECT_FALSE(stream.good());
+    EXPECT_EQ(std::string(out.data(), out.size()), "abcd");
+}
@@ -1,5 +1,8 @@
 ﻿#include <gtest/gtest.h>
 
+#include <memory_resource>
+#include <string>
+
 #include <pods/buffers.h>
 
 #include "storage_data.h"
@@ -122,3 +125,69 @@ TEST(resizeableBuffer, resize)
     EXPECT_EQ(e5, a5);
     EXPECT_EQ(in.get(a1), pods::Error::UnexpectedEnd);
 }
+
+TEST(resizeableBuffer, reserve)
+{
+    pods::ResizableOutputBuffer out(4, 16);
+
+    EXPECT_EQ(out.reserve(4), pods::Error::NoError);
+    EXPECT_EQ(out.capacity(), 4);
+    out.putUnchecked(static_cast<uint32_t>(1));
+
+    EXPECT_EQ(out.reserve(8), pods::Error::NoError);
+    EXPECT_EQ(out.capacity(), 16);
+    out.putUnchecked(static_cast<uint64_t>(2));
+
+    EXPECT_EQ(out.reserve(5), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.size(), 12);
+
+    uint32_t a1 = 0;
+    uint64_t a2 = 0;
+    pods::InputBuffer in(out.data(), out.size());
+    EXPECT_EQ(in.get(a1), pods::Error::NoError);
+    EXPECT_EQ(in.get(a2), pods::Error::NoError);
+    EXPECT_EQ(a1, 1);
+    EXPECT_EQ(a2, 2);
+}
+
+TEST(resizeableBuffer, move)
+{
+    pods::ResizableOutputBuffer first;
+    EXPECT_EQ(first.put(static_cast<uint32_t>(1)), pods::Error::NoError);
+    const auto data = first.data();
+
+    pods::ResizableOutputBuffer second(std::move(first));
+    EXPECT_EQ(second.data(), data);
+    EXPECT_EQ(second.size(), sizeof(uint32_t));
+    EXPECT_EQ(first.size(), 0);
+
+    // the moved from buffer is still usable
+    EXPECT_EQ(first.put(static_cast<uint64_t>(2)), pods::Error::NoError);
+    EXPECT_EQ(first.size(), sizeof(uint64_t));
+
+    second = std::move(first);
+    EXPECT_EQ(second.size(), sizeof(uint64_t));
+
+    uint64_t actual = 0;
+    pods::InputBuffer in(second.data(), second.size());
+    EXPECT_EQ(in.get(actual), pods::Error::NoError);
+    EXPECT_EQ(actual, 2);
+}
+
+TEST(resizeableBuffer, memoryResource)
+{
+    char arena[1024];
+    std::pmr::monotonic_buffer_resource upstream(arena, sizeof(arena), std::pmr::null_memory_resource());
+
+    pods::ResizableOutputBuffer out(4, 256, &upstream);
+    testSignedWrite(out);
+    EXPECT_GE(out.data(), arena);
+    EXPECT_LT(out.data(), arena + sizeof(arena));
+
+    pods::InputBuffer in(out.data(), out.size());
+    testSignedRead(in);
+
+    // the arena is exhausted, the error is reported instead of the exception
+    pods::ResizableOutputBuffer big(4, 4096, &upstream);
+    EXPECT_EQ(big.put(std::string(2048, 'x').c_str(), 2048), pods::Error::NotEnoughMemory);
+}
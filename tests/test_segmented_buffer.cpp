@@ -0,0 +1,142 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+#include <pods/segmented_buffer.h>
+
+#include "storage_data.h"
+
+namespace
+{
+    std::string flatten(const pods::SegmentedOutputBuffer& out)
+    {
+        std::string result(out.size(), '\0');
+        out.copyTo(&result[0]);
+        return result;
+    }
+}
+
+TEST(segmentedBuffer, testStorage)
+{
+    pods::SegmentedOutputBuffer out(7);
+    testSignedWrite(out);
+    testUnsignedWrite(out);
+    testFloatWrite(out);
+    testBoolWrite(out);
+    testCharWrite(out);
+    testRawDataWrite(out);
+
+    const auto data = flatten(out);
+
+    pods::InputBuffer in(data.data(), data.size());
+    testSignedRead(in);
+    testUnsignedRead(in);
+    testFloatRead(in);
+    testBoolRead(in);
+    testCharRead(in);
+    testRawDataRead(in);
+}
+
+TEST(segmentedBuffer, testIoVecs)
+{
+    pods::SegmentedOutputBuffer out(8);
+
+    EXPECT_EQ(out.size(), 0);
+    EXPECT_TRUE(out.getIoVecs().empty());
+
+    const std::string expected = "0123456789abcdefghij";
+    EXPECT_EQ(out.put(expected.data(), expected.size()), pods::Error::NoError);
+    EXPECT_EQ(out.size(), expected.size());
+
+    const auto iovecs = out.getIoVecs();
+    ASSERT_EQ(iovecs.size(), 3);
+    EXPECT_EQ(iovecs[0].iov_len, 8);
+    EXPECT_EQ(iovecs[1].iov_len, 8);
+    EXPECT_EQ(iovecs[2].iov_len, 4);
+
+    std::string actual;
+    for (const auto& iovec : iovecs)
+    {
+        actual.append(static_cast<const char*>(iovec.iov_base), iovec.iov_len);
+    }
+    EXPECT_EQ(expected, actual);
+
+    const auto first = iovecs[0].iov_base;
+
+    out.clear();
+    EXPECT_EQ(out.size(), 0);
+    EXPECT_EQ(out.put(static_cast<uint8_t>(1)), pods::Error::NoError);
+    EXPECT_EQ(out.getIoVecs().size(), 1);
+    EXPECT_EQ(out.getIoVecs()[0].iov_base, first);
+}
+
+TEST(segmentedBuffer, testMaxSize)
+{
+    pods::SegmentedOutputBuffer out(4, 6);
+
+    EXPECT_EQ(out.put(static_cast<uint32_t>(1)), pods::Error::NoError);
+    EXPECT_EQ(out.put(static_cast<uint32_t>(2)), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.put(static_cast<uint8_t>(3)), pods::Error::NoError);
+    EXPECT_EQ(out.put(static_cast<uint8_t>(4)), pods::Error::NoError);
+    EXPECT_EQ(out.put(static_cast<uint8_t>(5)), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.size(), 6);
+}
+
+TEST(segmentedBuffer, testPool)
+{
+    pods::SegmentPool pool(16);
+
+    const void* first = nullptr;
+
+    {
+        pods::SegmentedOutputBuffer out(pool);
+        EXPECT_EQ(out.segmentSize(), 16);
+        EXPECT_EQ(out.put(static_cast<uint64_t>(1)), pods::Error::NoError);
+        first = out.getIoVecs()[0].iov_base;
+    }
+
+    pods::SegmentedOutputBuffer out(pool);
+    EXPECT_EQ(out.put(static_cast<uint64_t>(1)), pods::Error::NoError);
+    EXPECT_EQ(out.getIoVecs()[0].iov_base, first);
+}
+
+struct Segmented
+{
+    std::string a = std::string(100, 'a');
+    std::vector<uint32_t> b = { 1, 2, 3, 0xffffffff, 100000 };
+    double c = 1.5;
+
+    PODS_SERIALIZABLE(PODS_MDR(a), PODS_MDR(b), PODS_MDR(c))
+};
+
+TEST(segmentedBuffer, testMsgPack)
+{
+    const Segmented expected;
+
+    pods::SegmentedOutputBuffer out(16);
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    pods::ResizableOutputBuffer reference;
+    pods::MsgPackSerializer<decltype(reference)> referenceSerializer(reference);
+    EXPECT_EQ(referenceSerializer.save(expected), pods::Error::NoError);
+
+    const auto data = flatten(out);
+    EXPECT_EQ(data, std::string(reference.data(), reference.size()));
+
+    Segmented actual;
+    actual.a.clear();
+    actual.b.clear();
+    actual.c = 0;
+
+    pods::InputBuffer in(data.data(), data.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+
+    EXPECT_EQ(expected.a, actual.a);
+    EXPECT_EQ(expected.b, actual.b);
+    EXPECT_EQ(expected.c, actual.c);
+}
@@ -0,0 +1,67 @@
+﻿#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pods/buffers.h>
+#include <pods/json.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+#include <pods/serialized_size.h>
+
+struct Sized
+{
+    struct Item
+    {
+        int32_t x = -100000;
+        double y = 0.5;
+        bool z = true;
+
+        PODS_SERIALIZABLE(PODS_MDR(x), PODS_OPT(y), PODS_MDR(z))
+    };
+
+    uint8_t a = 200;
+    int64_t b = -5000000000;
+    std::string c = "hello \"world\"\n";
+    std::string d = std::string(300, 'd');
+    std::vector<Item> e = std::vector<Item>(20);
+    std::map<std::string, uint16_t> f = { { "one", 1 }, { "two", 60000 } };
+    std::vector<uint32_t> g = { 1, 2, 3, 4, 5 };
+
+    PODS_SERIALIZABLE(PODS_MDR(a), PODS_MDR(b), PODS_MDR(c), PODS_MDR(d), PODS_MDR(e), PODS_MDR(f), PODS_MDR_BIN(g))
+};
+
+template <template <class> class Serializer>
+void testSerializedSize()
+{
+    Sized data;
+
+    size_t size = 0;
+    EXPECT_EQ(pods::serializedSize<Serializer>(data, size), pods::Error::NoError);
+
+    pods::ResizableOutputBuffer reference;
+    Serializer<decltype(reference)> serializer(reference);
+    EXPECT_EQ(serializer.save(data), pods::Error::NoError);
+    EXPECT_EQ(size, reference.size());
+
+    pods::OutputBuffer out(size);
+    Serializer<decltype(out)> exactSerializer(out);
+    EXPECT_EQ(exactSerializer.save(data), pods::Error::NoError);
+    EXPECT_EQ(out.available(), 0);
+}
+
+TEST(json, testSerializedSize)
+{
+    testSerializedSize<pods::JsonSerializer>();
+}
+
+TEST(prettyJson, testSerializedSize)
+{
+    testSerializedSize<pods::PrettyJsonSerializer>();
+}
+
+TEST(msgpack, testSerializedSize)
+{
+    testSerializedSize<pods::MsgPackSerializer>();
+}
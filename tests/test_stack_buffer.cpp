@@ -0,0 +1,82 @@
+﻿#include <gtest/gtest.h>
+
+#include <string>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+
+#include "data.h"
+#include "storage_data.h"
+
+TEST(stackBuffer, testStorage)
+{
+    pods::StackOutputBuffer<16> out;
+    testSignedWrite(out);
+    testUnsignedWrite(out);
+    testFloatWrite(out);
+    testBoolWrite(out);
+    testCharWrite(out);
+    testRawDataWrite(out);
+
+    EXPECT_FALSE(out.isInline());
+
+    pods::InputBuffer in(out.data(), out.size());
+    testSignedRead(in);
+    testUnsignedRead(in);
+    testFloatRead(in);
+    testBoolRead(in);
+    testCharRead(in);
+    testRawDataRead(in);
+}
+
+TEST(stackBuffer, inline)
+{
+    pods::StackOutputBuffer<8> out;
+    EXPECT_EQ(out.put(static_cast<uint32_t>(1)), pods::Error::NoError);
+    EXPECT_EQ(out.reserve(4), pods::Error::NoError);
+    out.putUnchecked(static_cast<uint32_t>(2));
+    EXPECT_TRUE(out.isInline());
+    EXPECT_EQ(out.capacity(), 8);
+
+    EXPECT_EQ(out.put('x'), pods::Error::NoError);
+    EXPECT_FALSE(out.isInline());
+    EXPECT_EQ(out.size(), 9);
+
+    uint32_t a1 = 0;
+    uint32_t a2 = 0;
+    char a3 = 0;
+    pods::InputBuffer in(out.data(), out.size());
+    EXPECT_EQ(in.get(a1), pods::Error::NoError);
+    EXPECT_EQ(in.get(a2), pods::Error::NoError);
+    EXPECT_EQ(in.get(a3), pods::Error::NoError);
+    EXPECT_EQ(a1, 1);
+    EXPECT_EQ(a2, 2);
+    EXPECT_EQ(a3, 'x');
+}
+
+TEST(stackBuffer, maxSize)
+{
+    pods::StackOutputBuffer<4> out(6);
+    EXPECT_EQ(out.put(static_cast<uint32_t>(1)), pods::Error::NoError);
+    EXPECT_EQ(out.put(static_cast<uint32_t>(2)), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.put(static_cast<uint16_t>(3)), pods::Error::NoError);
+    EXPECT_EQ(out.put('x'), pods::Error::NotEnoughMemory);
+    EXPECT_EQ(out.size(), 6);
+}
+
+TEST(stackBuffer, serializer)
+{
+    const TestData data;
+
+    pods::ResizableOutputBuffer expected;
+    pods::MsgPackSerializer<decltype(expected)> expectedSerializer(expected);
+    EXPECT_EQ(expectedSerializer.save(data), pods::Error::NoError);
+
+    pods::StackOutputBuffer<256> actual;
+    pods::MsgPackSerializer<decltype(actual)> actualSerializer(actual);
+    EXPECT_EQ(actualSerializer.save(data), pods::Error::NoError);
+
+    EXPECT_TRUE(actual.isInline());
+    EXPECT_EQ(std::string(expected.data(), expected.size()), std::string(actual.data(), actual.size()));
+}
@@ -5,8 +5,72 @@
 #include <sstream>
 #include <vector>
 
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
 #include <pods/streams.h>
 
+namespace
+{
+    // a pipe-like source: hands out data in small portions and can't seek
+    class ChunkedStreamBuf final
+        : public std::streambuf
+    {
+    public:
+        ChunkedStreamBuf(const char* data, size_t size, size_t chunkSize)
+            : data_(data)
+            , size_(size)
+            , chunkSize_(chunkSize)
+            , pos_(0)
+            , delivered_(0)
+        {
+        }
+
+        size_t delivered() const noexcept
+        {
+            return delivered_;
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() != egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            if (pos_ == size_)
+            {
+                return traits_type::eof();
+            }
+
+            const auto n = std::min(chunkSize_, size_ - pos_);
+            std::copy_n(data_ + pos_, n, chunk_);
+            pos_ += n;
+            delivered_ += n;
+            setg(chunk_, chunk_, chunk_ + n);
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        const char* data_;
+        const size_t size_;
+        const size_t chunkSize_;
+        size_t pos_;
+        size_t delivered_;
+        char chunk_[16];
+    };
+
+    struct Message
+    {
+        uint32_t id = 100500;
+        std::string text = "some text to read through the pipe";
+        std::vector<int64_t> values = { 1, -1, -100, 1000000, -1000000, 0x7fffffffffff };
+
+        PODS_SERIALIZABLE(PODS_MDR(id), PODS_MDR(text), PODS_MDR(values))
+    };
+}
+
 TEST(stream, common)
 {
     std::stringstream buffer;
@@ -148,3 +212,60 @@ TEST(stream, autoFlush)
     EXPECT_EQ(in.get(actual), pods::Error::NoError);
     EXPECT_EQ(expected, actual);
 }
+
+TEST(stream, nonSeekable)
+{
+    const Message expected;
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    for (size_t chunkSize = 1; chunkSize <= 16; ++chunkSize)
+    {
+        ChunkedStreamBuf source(out.data(), out.size(), chunkSize);
+        std::istream stream(&source);
+
+        Message actual;
+        actual.id = 0;
+        actual.text.clear();
+        actual.values.clear();
+
+        pods::InputStream in(stream, 8);
+        pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+        EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+
+        EXPECT_EQ(expected.id, actual.id);
+        EXPECT_EQ(expected.text, actual.text);
+        EXPECT_EQ(expected.values, actual.values);
+
+        EXPECT_EQ(source.delivered(), out.size());
+
+        uint8_t tail = 0;
+        EXPECT_EQ(in.get(tail), pods::Error::UnexpectedEnd);
+    }
+}
+
+TEST(stream, bigRead)
+{
+    std::string expected(1000, '\0');
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        expected[i] = static_cast<char>(i);
+    }
+
+    ChunkedStreamBuf source(expected.data(), expected.size(), 7);
+    std::istream stream(&source);
+
+    pods::InputStream in(stream, 16);
+
+    uint8_t first = 0;
+    EXPECT_EQ(in.get(first), pods::Error::NoError);
+    EXPECT_EQ(first, 0);
+
+    std::string actual(expected.size() - 1, '\0');
+    EXPECT_EQ(in.get(&actual[0], actual.size()), pods::Error::NoError);
+    EXPECT_EQ(expected.substr(1), actual);
+
+    EXPECT_EQ(in.get(first), pods::Error::UnexpectedEnd);
+}
@@ -1,9 +1,12 @@
 ﻿#include <gtest/gtest.h>
 
+#include <sstream>
+
 #include <pods/buffers.h>
 #include <pods/json.h>
 #include <pods/msgpack.h>
 #include <pods/pods.h>
+#include <pods/streams.h>
 
 struct String
 {
@@ -48,6 +51,48 @@ TEST(json, testString)
     testString<pods::JsonSerializer<pods::ResizableOutputBuffer>, pods::JsonDeserializer<pods::InputBuffer>>();
 }
 
+// the contiguous buffers are written by pointer, the stream char by char
+template <template <class> class Serializer>
+void testStringStorages()
+{
+    String expected;
+    expected.a = "quote \" backslash \\ control \x01\n\t";
+
+    std::ostringstream stream;
+    {
+        pods::OutputStream out(stream);
+        Serializer<decltype(out)> serializer(out);
+        EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+    }
+
+    const auto json = stream.str();
+
+    pods::ResizableOutputBuffer resizable(16);
+    Serializer<decltype(resizable)> resizableSerializer(resizable);
+    EXPECT_EQ(resizableSerializer.save(expected), pods::Error::NoError);
+    EXPECT_EQ(std::string(resizable.data(), resizable.size()), json);
+
+    pods::StackOutputBuffer<16> stack;
+    Serializer<decltype(stack)> stackSerializer(stack);
+    EXPECT_EQ(stackSerializer.save(expected), pods::Error::NoError);
+    EXPECT_EQ(std::string(stack.data(), stack.size()), json);
+
+    pods::OutputBuffer exact(json.size());
+    Serializer<decltype(exact)> exactSerializer(exact);
+    EXPECT_EQ(exactSerializer.save(expected), pods::Error::NoError);
+    EXPECT_EQ(std::string(exact.data(), exact.size()), json);
+
+    pods::OutputBuffer small(json.size() - 1);
+    Serializer<decltype(small)> smallSerializer(small);
+    EXPECT_EQ(smallSerializer.save(expected), pods::Error::WriteError);
+}
+
+TEST(json, testStringStorages)
+{
+    testStringStorages<pods::JsonSerializer>();
+    testStringStorages<pods::PrettyJsonSerializer>();
+}
+
 TEST(msgpack, testString)
 {
     testString<pods::MsgPackSerializer<pods::ResizableOutputBuffer>, pods::MsgPackDeserializer<pods::InputBuffer>>();
@@ -0,0 +1,94 @@
+﻿#include <gtest/gtest.h>
+
+#include <span>
+#include <string_view>
+
+#include <pods/buffers.h>
+#include <pods/msgpack.h>
+#include <pods/pods.h>
+
+struct Views
+{
+    std::string_view a;
+    std::string_view b = "some text";
+    std::string_view c;
+    std::span<const char> d;
+    std::span<const uint8_t> e;
+
+    PODS_SERIALIZABLE(PODS_MDR(a), PODS_MDR(b), PODS_MDR(c), PODS_MDR(d), PODS_MDR(e))
+};
+
+struct Words
+{
+    std::span<const uint32_t> a;
+
+    PODS_SERIALIZABLE(PODS_MDR(a))
+};
+
+bool isInside(const void* ptr, const pods::ResizableOutputBuffer& out)
+{
+    const auto p = static_cast<const char*>(ptr);
+    return p >= out.data() && p < out.data() + out.size();
+}
+
+TEST(msgpack, testViews)
+{
+    const std::string c(std::numeric_limits<uint16_t>::max() + 1, 'c');
+    const char d[] = { 1, 2, 3 };
+    const uint8_t e[] = { 4, 5, 6, 7 };
+
+    Views expected;
+    expected.c = c;
+    expected.d = d;
+    expected.e = e;
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    Views actual;
+    actual.a = "fail";
+    actual.b = {};
+
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::NoError);
+
+    EXPECT_EQ(expected.a, actual.a);
+    EXPECT_EQ(expected.b, actual.b);
+    EXPECT_EQ(expected.c, actual.c);
+    EXPECT_TRUE(std::equal(expected.d.begin(), expected.d.end(), actual.d.begin(), actual.d.end()));
+    EXPECT_TRUE(std::equal(expected.e.begin(), expected.e.end(), actual.e.begin(), actual.e.end()));
+
+    EXPECT_TRUE(isInside(actual.b.data(), out));
+    EXPECT_TRUE(isInside(actual.c.data(), out));
+    EXPECT_TRUE(isInside(actual.d.data(), out));
+    EXPECT_TRUE(isInside(actual.e.data(), out));
+}
+
+TEST(msgpack, testViewsAlignment)
+{
+    const uint32_t a[] = { 1, 2, 3 };
+
+    Words expected;
+    expected.a = a;
+
+    pods::ResizableOutputBuffer out;
+    pods::MsgPackSerializer<decltype(out)> serializer(out);
+    EXPECT_EQ(serializer.save(expected), pods::Error::NoError);
+
+    // Bin8 header takes 2 bytes, so the payload is misaligned
+    Words actual;
+    pods::InputBuffer in(out.data(), out.size());
+    pods::MsgPackDeserializer<decltype(in)> deserializer(in);
+    EXPECT_EQ(deserializer.load(actual), pods::Error::UnalignedData);
+
+    // shift the archive to make the payload aligned
+    alignas(uint32_t) char aligned[64] = {};
+    std::copy_n(out.data(), out.size(), aligned + 2);
+
+    pods::InputBuffer alignedIn(aligned + 2, out.size());
+    pods::MsgPackDeserializer<decltype(alignedIn)> alignedDeserializer(alignedIn);
+    EXPECT_EQ(alignedDeserializer.load(actual), pods::Error::NoError);
+    EXPECT_TRUE(std::equal(expected.a.begin(), expected.a.end(), actual.a.begin(), actual.a.end()));
+}